@@ -27,11 +27,36 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
                                          size_t const key);
 
 
+/**
+ * Whether a key is in the set: in constant time for dense keys, such as
+ * sample IDs, which are kept in a bitset next to the tree.
+ */
 bool
 VRD_TEMPLATE(VRD_TYPENAME, _tree_is_element)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
                                              size_t const key);
 
 
+/**
+ * Turn the set into its complement: all keys but the inserted ones are
+ * elements, e.g., to leave one sample out of a query. Complementing it
+ * again restores the set.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_complement)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self);
+
+
+/**
+ * The (at most `len`) inserted keys in increasing order, regardless of
+ * the complement.
+ *
+ * @return The number of keys.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _tree_keys)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                       size_t const len,
+                                       size_t keys[len]);
+
+
 #undef VRD_TYPENAME
 
 
@@ -0,0 +1,222 @@
+/**
+ * @file: checkpoint.h
+ *
+ * Defines a single file container for checkpoints of (a collection of)
+ * tables. A checkpoint consists of a header, a sequence of sections and
+ * a directory that describes the sections. Each section is identified by
+ * the name of the table (e.g., "SNV") and an identifier within that
+ * table. Sections start on a page boundary, such that node arrays can be
+ * mapped directly into memory. Sections that hold trees are either raw
+ * node arrays or packed (see: vrd_*_tree_write_packed); only raw
+ * sections can be mapped.
+ *
+ * A checkpoint can be amended: new versions of sections are appended and
+ * replace their previous versions once the new directory is committed.
+ * Every commit has a new serial number, such that tables can tell
+ * whether they are in sync with the checkpoint they amend. The header
+ * records the bytes in use; once superseded sections take up most of the
+ * file, it is rewritten from scratch instead of amended.
+ *
+ * Sections can be read and written concurrently: every worker uses its
+ * own stream (see: vrd_checkpoint_stream()) and either seeks to the
+ * section it reads or reserves room for the section it writes.
+ *
+ * The tables define their own layout of the sections
+ * (see: ../src/template_table.inc).
+ */
+
+
+#ifndef VRD_CHECKPOINT_H
+#define VRD_CHECKPOINT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#include <stddef.h>     // size_t
+#include <stdint.h>     // UINT32_MAX, uint32_t, uint64_t
+#include <stdio.h>      // FILE
+
+
+// the section identifier for the index of a table
+static uint32_t const VRD_CHECKPOINT_INDEX = UINT32_MAX;
+// the section identifier for the retracted samples of a table
+static uint32_t const VRD_CHECKPOINT_RETRACTED = UINT32_MAX - 1;
+
+
+static unsigned int const VRD_CHECKPOINT_READ  = 1 << 0;
+static unsigned int const VRD_CHECKPOINT_WRITE = 1 << 1;
+static unsigned int const VRD_CHECKPOINT_MAP   = 1 << 2;    // read and map
+                                                            // the nodes
+static unsigned int const VRD_CHECKPOINT_PACK  = 1 << 3;    // write packed
+                                                            // trees
+static unsigned int const VRD_CHECKPOINT_INCREMENTAL = 1 << 4;  // amend an
+                                                                // existing
+                                                                // checkpoint
+
+
+// the encoding of a section
+static uint32_t const VRD_ENCODING_RAW    = 0;
+static uint32_t const VRD_ENCODING_PACKED = 1;
+
+
+typedef struct vrd_Checkpoint vrd_Checkpoint;
+
+
+vrd_Checkpoint*
+vrd_checkpoint_open(char const* const path, unsigned int const flags);
+
+
+/**
+ * Close a checkpoint. A checkpoint opened for writing is committed: the
+ * directory is written and the file replaces any previous checkpoint at
+ * the same path. An amended checkpoint is committed in place by
+ * rewriting its header.
+ */
+int
+vrd_checkpoint_close(vrd_Checkpoint** const self);
+
+
+/**
+ * Close a checkpoint opened for writing without committing it. Any
+ * previous checkpoint at the same path is left untouched; sections
+ * appended to an amended checkpoint are truncated.
+ */
+void
+vrd_checkpoint_abort(vrd_Checkpoint** const self);
+
+
+unsigned int
+vrd_checkpoint_flags(vrd_Checkpoint const* const self);
+
+
+/**
+ * The serial number of a checkpoint opened for reading, or the serial
+ * number a checkpoint opened for writing has once committed.
+ */
+uint64_t
+vrd_checkpoint_serial(vrd_Checkpoint const* const self);
+
+
+/**
+ * The serial number of the checkpoint that is amended, or 0 if it is
+ * written from scratch (also when it is rewritten to reclaim superseded
+ * sections). Sections of the amended checkpoint are kept, unless they
+ * are written again.
+ */
+uint64_t
+vrd_checkpoint_previous(vrd_Checkpoint const* const self);
+
+
+/**
+ * Set the number of worker threads the tables use to load and save
+ * their trees (default: 1).
+ */
+void
+vrd_checkpoint_set_threads(vrd_Checkpoint* const self, size_t const threads);
+
+
+size_t
+vrd_checkpoint_threads(vrd_Checkpoint const* const self);
+
+
+/**
+ * Open a new stream on the file of a checkpoint, for a single worker.
+ * The caller closes it with `fclose()`.
+ */
+FILE*
+vrd_checkpoint_stream(vrd_Checkpoint* const self);
+
+
+/**
+ * Start a new section in a checkpoint opened for writing.
+ *
+ * @param self refers to a checkpoint.
+ * @param table the name of the table (at most 4 characters).
+ * @param id the identifier of the section within the table.
+ * @param encoding the encoding of the contents (`VRD_ENCODING_*`).
+ * @return The stream to write the contents of the section to, or `NULL`
+ *         on error. The section ends with vrd_checkpoint_end().
+ */
+FILE*
+vrd_checkpoint_begin(vrd_Checkpoint* const self,
+                     char const* const table,
+                     uint32_t const id,
+                     uint32_t const encoding);
+
+
+int
+vrd_checkpoint_end(vrd_Checkpoint* const self);
+
+
+/**
+ * Reserve room for a section of a known size in a checkpoint opened for
+ * writing. Unlike vrd_checkpoint_begin(), this is safe for concurrent
+ * writers.
+ *
+ * @return The offset of the section in the file, or -1 on error.
+ */
+long
+vrd_checkpoint_reserve(vrd_Checkpoint* const self,
+                       char const* const table,
+                       uint32_t const id,
+                       uint32_t const encoding,
+                       size_t const size);
+
+
+/**
+ * Find a section in a checkpoint opened for reading.
+ *
+ * @param self refers to a checkpoint.
+ * @param table the name of the table.
+ * @param id the identifier of the section within the table.
+ * @param size is set to the size of the section in bytes.
+ * @param encoding is set to the encoding of the section, if not `NULL`.
+ * @return The stream positioned at the start of the section, or `NULL`
+ *         if the section does not exist.
+ */
+FILE*
+vrd_checkpoint_find(vrd_Checkpoint* const self,
+                    char const* const table,
+                    uint32_t const id,
+                    size_t* const size,
+                    uint32_t* const encoding);
+
+
+/**
+ * Position a stream (see: vrd_checkpoint_stream()) at the start of a
+ * section. This is safe for concurrent readers.
+ *
+ * @return 0 on success, -1 if the section does not exist, or an errno.
+ */
+int
+vrd_checkpoint_seek(vrd_Checkpoint* const self,
+                    FILE* const stream,
+                    char const* const table,
+                    uint32_t const id,
+                    size_t* const size,
+                    uint32_t* const encoding);
+
+
+/**
+ * Map a section of a checkpoint privately into memory. The caller owns
+ * the mapping and releases it with `munmap(addr, size)`.
+ *
+ * @return The address of the mapping, or `NULL` if the section does not
+ *         exist or cannot be mapped (e.g., it is packed or not aligned
+ *         to a page boundary on this system).
+ */
+void*
+vrd_checkpoint_map(vrd_Checkpoint* const self,
+                   char const* const table,
+                   uint32_t const id,
+                   size_t* const size);
+
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
@@ -13,7 +13,8 @@
  * specifies the template specialization for this table:
  *   - Insert a covered region into the table: vrd_Cov_table_insert()
  *   - Query (count, stab) the table for a given interval:
- *     vrd_Cov_table_query_stab()
+ *     vrd_Cov_table_query_stab(), or for many at once:
+ *     vrd_Cov_table_query_stab_batch()
  *
  * The interface uses a platform specific integer for most data points
  * (size_t), however the implementation may limit the range of these data
@@ -87,6 +88,44 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query_stab)(VRD_TEMPLATE(VRD_TYPENAME, _Table)
                                               vrd_AVL_Tree const* const subset);
 
 
+/**
+ * The allele counts of `n` regions on a reference, as with
+ * vrd_Cov_table_query_stab(). The lookups descend the tree in lockstep,
+ * such that their cache misses overlap.
+ *
+ * @return 0 on success, or -1 for an unknown reference; all results are
+ *         (size_t) -1 then.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_stab_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                    size_t const len,
+                                                    char const reference[len],
+                                                    size_t const n,
+                                                    size_t const start[n],
+                                                    size_t const end[n],
+                                                    vrd_AVL_Tree const* const subset,
+                                                    size_t result[n]);
+
+
+/**
+ * The allele counts of `n` regions on a reference in order of start, as
+ * with vrd_Cov_table_query_stab(), answered by a single sweep along the
+ * tree (see: vrd_Cov_tree_query_stab_sorted).
+ *
+ * @return 0 on success, or -1 for an unknown reference; all results are
+ *         (size_t) -1 then.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_stab_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                     size_t const len,
+                                                     char const reference[len],
+                                                     size_t const n,
+                                                     size_t const start[n],
+                                                     size_t const end[n],
+                                                     vrd_AVL_Tree const* const subset,
+                                                     size_t result[n]);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                                 size_t const len_ref,
@@ -15,6 +15,7 @@ typedef struct vrd_Diagnostics
     char* reference;
     size_t entries;
     size_t entry_size;
+    size_t capacity;    // the number of allocated entries
     size_t height;
 } vrd_Diagnostics;
 
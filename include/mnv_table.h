@@ -45,6 +45,48 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query)(VRD_TEMPLATE(VRD_TYPENAME, _Table) cons
                                          vrd_AVL_Tree const* const subset);
 
 
+/**
+ * The allele counts of `n` MNVs on a reference, as with
+ * vrd_MNV_table_query(). The lookups descend the tree in lockstep,
+ * such that their cache misses overlap.
+ *
+ * @return 0 on success, or -1 for an unknown reference; all results are
+ *         (size_t) -1 then.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                               size_t const len,
+                                               char const reference[len],
+                                               size_t const n,
+                                               size_t const start[n],
+                                               size_t const end[n],
+                                               size_t const inserted[n],
+                                               bool const homozygous,
+                                               vrd_AVL_Tree const* const subset,
+                                               size_t result[n]);
+
+
+/**
+ * The allele counts of `n` MNVs on a reference in order of start, as
+ * with vrd_MNV_table_query(): a single forward pass over the tree
+ * answers all of them (see: vrd_MNV_tree_query_sorted).
+ *
+ * @return 0 on success, or -1 for an unknown reference; all results are
+ *         (size_t) -1 then.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                size_t const len,
+                                                char const reference[len],
+                                                size_t const n,
+                                                size_t const start[n],
+                                                size_t const end[n],
+                                                size_t const inserted[n],
+                                                bool const homozygous,
+                                                vrd_AVL_Tree const* const subset,
+                                                size_t result[n]);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                                 size_t const len_ref,
@@ -56,12 +98,40 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tabl
                                                 void* result[len_res]);
 
 
+/**
+ * The allele count of the MNVs on a reference that start in the region
+ * [start, end), of only the homozygous ones if `homozygous` is set.
+ * Built with VRD_SUBTREE_SUMS and without a subset this takes O(log n)
+ * time, otherwise the nodes in the region are counted.
+ *
+ * @return The allele count, or `(size_t) -1` if the reference does not
+ *         exist.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_region_count)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                      size_t const len,
+                                                      char const reference[len],
+                                                      size_t const start,
+                                                      size_t const end,
+                                                      bool const homozygous,
+                                                      vrd_AVL_Tree const* const subset);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_remove_seq)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
                                               vrd_AVL_Tree const* const subset,
                                               vrd_Seq_Table* const seq_table);
 
 
+/**
+ * Compact the table (see: vrd_MNV_table_compact) and remove the
+ * inserted sequences of the removed entries from the sequence table.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_compact_seq)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
+                                               vrd_Seq_Table* const seq_table);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_export)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                           FILE* stream,
@@ -9,6 +9,7 @@ extern "C"
 
 #include <stddef.h>     // size_t
 
+#include "checkpoint.h"     // vrd_Checkpoint
 #include "diagnostics.h"    // vrd_Diagnostics
 #include "trie.h"   // vrd_Trie_Node
 
@@ -24,6 +25,17 @@ void
 vrd_Seq_table_destroy(vrd_Seq_Table** const self);
 
 
+/**
+ * Lock a table against other writers (see: vrd_*_table_lock).
+ */
+void
+vrd_Seq_table_lock(vrd_Seq_Table* const self);
+
+
+void
+vrd_Seq_table_unlock(vrd_Seq_Table* const self);
+
+
 vrd_Trie_Node*
 vrd_Seq_table_insert(vrd_Seq_Table* const self,
                      size_t const len,
@@ -46,6 +58,16 @@ int
 vrd_Seq_table_remove(vrd_Seq_Table* const self, size_t const elem);
 
 
+int
+vrd_Seq_table_load(vrd_Seq_Table* const self,
+                   vrd_Checkpoint* const checkpoint);
+
+
+int
+vrd_Seq_table_save(vrd_Seq_Table const* const self,
+                   vrd_Checkpoint* const checkpoint);
+
+
 int
 vrd_Seq_table_read(vrd_Seq_Table* const self, char const* const path);
 
@@ -42,6 +42,46 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query)(VRD_TEMPLATE(VRD_TYPENAME, _Table) cons
                                          vrd_AVL_Tree const* const subset);
 
 
+/**
+ * The allele counts of `n` SNVs on a reference, as with
+ * vrd_SNV_table_query(). The lookups descend the tree in lockstep,
+ * such that their cache misses overlap.
+ *
+ * @return 0 on success, or -1 for an unknown reference; all results are
+ *         (size_t) -1 then.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                               size_t const len,
+                                               char const reference[len],
+                                               size_t const n,
+                                               size_t const position[n],
+                                               size_t const inserted[n],
+                                               bool const homozygous,
+                                               vrd_AVL_Tree const* const subset,
+                                               size_t result[n]);
+
+
+/**
+ * The allele counts of `n` SNVs on a reference in order of position, as
+ * with vrd_SNV_table_query(): a single forward pass over the tree
+ * answers all of them (see: vrd_SNV_tree_query_sorted).
+ *
+ * @return 0 on success, or -1 for an unknown reference; all results are
+ *         (size_t) -1 then.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                size_t const len,
+                                                char const reference[len],
+                                                size_t const n,
+                                                size_t const position[n],
+                                                size_t const inserted[n],
+                                                bool const homozygous,
+                                                vrd_AVL_Tree const* const subset,
+                                                size_t result[n]);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                                 size_t const len_ref,
@@ -53,6 +93,25 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tabl
                                                 void* result[len_res]);
 
 
+/**
+ * The allele count of the SNVs on a reference in the region
+ * [start, end), of only the homozygous ones if `homozygous` is set.
+ * Built with VRD_SUBTREE_SUMS and without a subset this takes O(log n)
+ * time, otherwise the nodes in the region are counted.
+ *
+ * @return The allele count, or `(size_t) -1` if the reference does not
+ *         exist.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_region_count)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                      size_t const len,
+                                                      char const reference[len],
+                                                      size_t const start,
+                                                      size_t const end,
+                                                      bool const homozygous,
+                                                      vrd_AVL_Tree const* const subset);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_export)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                           FILE* stream);
@@ -6,5 +6,9 @@
 
 #define VRD_TEMPLATE(type, suffix) VRD_TEMPLATE_WRAP(suffix, type)
 
+#define VRD_TEMPLATE_STR_WRAP(type) #type
+
+#define VRD_TEMPLATE_STR(type) VRD_TEMPLATE_STR_WRAP(type)
+
 
 #endif
@@ -9,26 +9,103 @@ extern "C"
 
 #include <stddef.h>     // size_t
 #include <stdio.h>      // FILE
+#include <sys/types.h>  // pid_t
 
 #include "../include/avl_tree.h"    // vrd_AVL_Tree
 #include "../include/cov_table.h"   // vrd_Cov_Table
 #include "../include/mnv_table.h"   // vrd_MNV_Table
 #include "../include/seq_table.h"   // vrd_Seq_Table
 #include "../include/snv_table.h"   // vrd_SNV_Table
+#include "../include/wal.h"         // vrd_WAL
 
 
+/**
+ * Import the coverage of a sample. Every region is logged to the
+ * write-ahead log (if not `NULL`) before it is inserted; the log is
+ * committed at the end of the import. The table is locked for the whole
+ * import (see: vrd_*_table_lock).
+ */
 size_t
 vrd_coverage_from_file(FILE* stream,
                        vrd_Cov_Table* const cov,
-                       size_t const sample_id);
+                       size_t const sample_id,
+                       vrd_WAL* const wal);
 
 
+/**
+ * Import the variants of a sample, see vrd_coverage_from_file().
+ */
 size_t
 vrd_variants_from_file(FILE* stream,
                        vrd_SNV_Table* const snv,
                        vrd_MNV_Table* const mnv,
                        vrd_Seq_Table* const seq,
-                       size_t const sample_id);
+                       size_t const sample_id,
+                       vrd_WAL* const wal);
+
+
+int
+vrd_database_read(char const* const path,
+                  vrd_Cov_Table* const cov,
+                  vrd_SNV_Table* const snv,
+                  vrd_MNV_Table* const mnv,
+                  vrd_Seq_Table* const seq,
+                  size_t const threads);
+
+
+int
+vrd_database_map(char const* const path,
+                 vrd_Cov_Table* const cov,
+                 vrd_SNV_Table* const snv,
+                 vrd_MNV_Table* const mnv,
+                 vrd_Seq_Table* const seq,
+                 size_t const threads);
+
+
+int
+vrd_database_write(char const* const path,
+                   vrd_Cov_Table const* const cov,
+                   vrd_SNV_Table const* const snv,
+                   vrd_MNV_Table const* const mnv,
+                   vrd_Seq_Table const* const seq,
+                   unsigned int const flags,
+                   size_t const threads);
+
+
+/**
+ * Write a point-in-time checkpoint of the tables in the background
+ * (see: vrd_database_write()). A forked process writes the tables as
+ * they are now, while the caller continues to modify them; the memory
+ * is shared copy-on-write.
+ *
+ * The fork waits for the writers that hold the locks of the tables
+ * (see: vrd_*_table_lock), e.g., a sample that is being imported. Other
+ * threads must not modify the tables without holding their locks. The
+ * forked process writes with a single thread, and relies on `malloc()`
+ * and stdio being safe to use after a fork (as with glibc).
+ *
+ * As the forked process does not report back, the tables are not in
+ * sync with the checkpoint for a next incremental write.
+ *
+ * @return The process id of the writer, to be passed to
+ *         vrd_snapshot_wait(), or -1 on error.
+ */
+pid_t
+vrd_database_snapshot(char const* const path,
+                      vrd_Cov_Table* const cov,
+                      vrd_SNV_Table* const snv,
+                      vrd_MNV_Table* const mnv,
+                      vrd_Seq_Table* const seq,
+                      unsigned int const flags);
+
+
+/**
+ * Wait for a background snapshot to finish.
+ *
+ * @return The result of the write: 0 on success, an errno or -1.
+ */
+int
+vrd_snapshot_wait(pid_t const pid);
 
 
 size_t
@@ -41,6 +118,23 @@ vrd_annotate_from_file(FILE* ostream,
                        vrd_AVL_Tree const* const subset);
 
 
+/**
+ * Annotate a file of variants that is sorted by reference and position,
+ * as with vrd_annotate_from_file(), with a single forward pass over the
+ * trees of every reference: the lines of a chunk are merged with the
+ * trees (see: vrd_*_table_query_sorted). Unsorted lines are annotated
+ * correctly, only slower.
+ */
+size_t
+vrd_annotate_sorted_from_file(FILE* ostream,
+                              FILE* istream,
+                              vrd_Cov_Table const* const cov,
+                              vrd_SNV_Table const* const snv,
+                              vrd_MNV_Table const* const mnv,
+                              vrd_Seq_Table const* const seq,
+                              vrd_AVL_Tree const* const subset);
+
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -32,6 +32,7 @@ vrd_version(int* const major,
 
 
 #include "avl_tree.h"       // vrd_AVL_Tree, vrd_AVL_tree_*
+#include "checkpoint.h"     // vrd_Checkpoint, vrd_checkpoint_*
 #include "constants.h"      // VRD_MAX_*
 #include "cov_table.h"      // vrd_Cov_Table, vrd_Cov_table_*
 #include "diagnostics.h"    // vrd_Diagnostics
@@ -41,8 +42,10 @@ vrd_version(int* const major,
 #include "seq_table.h"      // vrd_Seq_Table, vrd_Seq_table_*
 #include "snv_table.h"      // vrd_SNV_Table, vrd_SNV_table_*
 #include "trie.h"           // vrd_Trie_Node, vrd_Trie, vrd_trie_*
+#include "wal.h"            // vrd_WAL, vrd_wal_*
 #include "utils.h"          // vrd_coverage_from_file,
                             // vrd_variants_from_file,
+                            // vrd_database_*,
                             // vrd_annotate_from_file
 
 
@@ -0,0 +1,168 @@
+/**
+ * @file: wal.h
+ *
+ * Defines an append-only write-ahead log (WAL) of the inserts into,
+ * removals from and retractions of samples in the tables. The log is based on a checkpoint (see:
+ * checkpoint.h): after a crash, the tables are read from that
+ * checkpoint and the log is replayed on top of it, such that recovery
+ * is proportional to the work done since the checkpoint.
+ *
+ * Records are written to the log before they are applied to the tables.
+ * They are made durable in groups (group commit): every `group` records,
+ * or explicitly with vrd_wal_commit(). Every record carries a checksum;
+ * a torn record at the end of the log (e.g., after a crash) ends the
+ * log.
+ *
+ * After a new checkpoint is written, the log is reset with
+ * vrd_wal_reset() to be based on that checkpoint.
+ */
+
+
+#ifndef VRD_WAL_H
+#define VRD_WAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#include <stddef.h>     // size_t
+
+#include "cov_table.h"  // vrd_Cov_Table
+#include "mnv_table.h"  // vrd_MNV_Table
+#include "seq_table.h"  // vrd_Seq_Table
+#include "snv_table.h"  // vrd_SNV_Table
+
+
+// the tables a removal (or a retraction) applies to
+static unsigned int const VRD_WAL_COV = 1 << 0;
+static unsigned int const VRD_WAL_SNV = 1 << 1;
+static unsigned int const VRD_WAL_MNV = 1 << 2;    // and its sequences
+
+
+typedef struct vrd_WAL vrd_WAL;
+
+
+/**
+ * Open a log for appending. A new log is based on no checkpoint at all.
+ *
+ * @param path the path of the log.
+ * @param group the number of records per commit, 0 to only commit
+ *              explicitly.
+ * @return The log, or `NULL` on error.
+ */
+vrd_WAL*
+vrd_wal_open(char const* const path, size_t const group);
+
+
+/**
+ * Commit and close a log.
+ */
+int
+vrd_wal_close(vrd_WAL** const self);
+
+
+/**
+ * Make all records appended so far durable.
+ */
+int
+vrd_wal_commit(vrd_WAL* const self);
+
+
+/**
+ * Empty the log and base it on the checkpoint at the given path, after
+ * the tables were written to it.
+ */
+int
+vrd_wal_reset(vrd_WAL* const self, char const* const checkpoint);
+
+
+int
+vrd_wal_cov_insert(vrd_WAL* const self,
+                   size_t const len,
+                   char const reference[len],
+                   size_t const start,
+                   size_t const end,
+                   size_t const count,
+                   size_t const sample_id);
+
+
+int
+vrd_wal_snv_insert(vrd_WAL* const self,
+                   size_t const len,
+                   char const reference[len],
+                   size_t const position,
+                   size_t const count,
+                   size_t const sample_id,
+                   size_t const phase,
+                   size_t const inserted);
+
+
+/**
+ * The inserted sequence is logged as is, its index in the sequence
+ * table is only known when the record is applied.
+ */
+int
+vrd_wal_mnv_insert(vrd_WAL* const self,
+                   size_t const len,
+                   char const reference[len],
+                   size_t const start,
+                   size_t const end,
+                   size_t const count,
+                   size_t const sample_id,
+                   size_t const phase,
+                   size_t const inserted_len,
+                   char const inserted[inserted_len]);
+
+
+int
+vrd_wal_remove(vrd_WAL* const self,
+               unsigned int const tables,
+               size_t const n,
+               size_t const sample_id[n]);
+
+
+/**
+ * A retracted sample (see: vrd_*_table_retract) is hidden again by the
+ * replay, until a compaction is replayed as well.
+ */
+int
+vrd_wal_retract(vrd_WAL* const self,
+                unsigned int const tables,
+                size_t const sample_id);
+
+
+/**
+ * The compaction of the tables (see: vrd_*_table_compact), of the
+ * sequences as well for the MNV table (see:
+ * vrd_MNV_table_compact_seq).
+ */
+int
+vrd_wal_compact(vrd_WAL* const self, unsigned int const tables);
+
+
+/**
+ * Replay a log on top of the tables read from the checkpoint at the
+ * given path (`NULL` for empty tables). A log that is based on another
+ * checkpoint is not replayed: its records are part of a newer
+ * checkpoint.
+ *
+ * @param count is set to the number of replayed records.
+ * @return 0 on success, an errno or -1 for a malformed log.
+ */
+int
+vrd_wal_replay(char const* const path,
+               char const* const checkpoint,
+               vrd_Cov_Table* const cov,
+               vrd_SNV_Table* const snv,
+               vrd_MNV_Table* const mnv,
+               vrd_Seq_Table* const seq,
+               size_t* const count);
+
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
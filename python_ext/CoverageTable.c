@@ -38,7 +38,9 @@ CoverageTable_insert(CoverageTableObject* const self, PyObject* const args)
 
     int ret = 0;
     Py_BEGIN_ALLOW_THREADS
+    vrd_Cov_table_lock(self->table);
     ret = vrd_Cov_table_insert(self->table, len + 1, reference, start, end, allele_count, sample_id);
+    vrd_Cov_table_unlock(self->table);
     Py_END_ALLOW_THREADS
 
     if (0 != ret)
@@ -198,7 +200,9 @@ CoverageTable_remove(CoverageTableObject* const self, PyObject* const args)
 
     size_t result = 0;
     Py_BEGIN_ALLOW_THREADS
+    vrd_Cov_table_lock(self->table);
     result = vrd_Cov_table_remove(self->table, subset);
+    vrd_Cov_table_unlock(self->table);
     vrd_AVL_tree_destroy(&subset);
     Py_END_ALLOW_THREADS
 
@@ -206,6 +210,22 @@ CoverageTable_remove(CoverageTableObject* const self, PyObject* const args)
 } // CoverageTable_remove
 
 
+static PyObject*
+CoverageTable_compact(CoverageTableObject* const self, PyObject* const args)
+{
+    (void) args;
+
+    size_t result = 0;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_Cov_table_lock(self->table);
+    result = vrd_Cov_table_compact(self->table);
+    vrd_Cov_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
+    return Py_BuildValue("i", result);
+} // CoverageTable_compact
+
+
 static PyMethodDef CoverageTable_methods[] =
 {
     {"insert", (PyCFunction) CoverageTable_insert, METH_VARARGS,
@@ -248,19 +268,46 @@ static PyMethodDef CoverageTable_methods[] =
      ":return: The number of removed covered regions\n"
      ":rtype: integer\n"},
 
+    {"retract", (PyCFunction) CoverageTable_retract, METH_VARARGS,
+     "retract(sample_id)\n"
+     "Hide a sample from all queries on the :py:class:`CoverageTable` until it is\n"
+     "removed by :py:meth:`compact`\n\n"
+     ":param integer sample_id: The sample ID\n"},
+
+    {"compact", (PyCFunction) CoverageTable_compact, METH_NOARGS,
+     "compact()\n"
+     "Remove the retracted samples from the :py:class:`CoverageTable`\n\n"
+     ":return: The number of removed entries\n"
+     ":rtype: integer\n"},
+
     {"reorder", (PyCFunction) CoverageTable_reorder, METH_NOARGS,
      "reorder()\n"
      "Reorders all structures in the :py:class:`CoverageTable`\n\n"},
 
+    {"freeze", (PyCFunction) CoverageTable_freeze, METH_NOARGS,
+     "freeze()\n"
+     "Makes the :py:class:`CoverageTable` read-only in a compact layout for\n"
+     "faster queries\n\n"},
+
+    {"index", (PyCFunction) CoverageTable_index, METH_NOARGS,
+     "index()\n"
+     "(Re)builds a read-only copy of the modified structures in the\n"
+     ":py:class:`CoverageTable` for faster queries, until they are modified again\n\n"},
+
     {"read", (PyCFunction) CoverageTable_read, METH_VARARGS,
      "read(path)\n"
-     "Read a :py:class:`CoverageTable` from files\n\n"
-     ":param string path: A path including a prefix that identifies the files\n"},
+     "Read a :py:class:`CoverageTable` from a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"},
+
+    {"map", (PyCFunction) CoverageTable_map, METH_VARARGS,
+     "map(path)\n"
+     "Map a :py:class:`CoverageTable` from a checkpoint file read-only into memory\n\n"
+     ":param string path: The path of the checkpoint file\n"},
 
     {"write", (PyCFunction) CoverageTable_write, METH_VARARGS,
      "write(path)\n"
-     "Write a :py:class:`CoverageTable` to files\n\n"
-     ":param string path: A path including a prefix that identifies the files\n"},
+     "Write a :py:class:`CoverageTable` to a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"},
 
     {"diagnostics", (PyCFunction) CoverageTable_diagnostics, METH_NOARGS,
      "diagnostics()\n"
@@ -280,7 +327,7 @@ PyTypeObject CoverageTable =
               "Table containing covered regions on a reference sequence.\n\n"
               ":param ref_capacity:  defaults to :c:data:`CFG_REF_CAPACITY`\n"
               ":type ref_capacity: integer, optional\n"
-              ":param tree_capacity:  defaults to :c:data:`CFG_REF_TREE_CAPACITY`\n"
+              ":param tree_capacity:  defaults to :c:data:`CFG_TREE_CAPACITY`, the initial number of entries per reference\n"
               ":type tree_capacity: integer, optional\n",
     .tp_basicsize = sizeof(CoverageTableObject),
     .tp_itemsize = 0,
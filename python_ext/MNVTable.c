@@ -41,7 +41,14 @@ MNVTable_insert(MNVTableObject* const self, PyObject* const args)
         return NULL;
     } // if
 
-    if (0 != vrd_MNV_table_insert(self->table, len + 1, reference, start, end, allele_count, sample_id, phase, inserted))
+    int ret = 0;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_MNV_table_lock(self->table);
+    ret = vrd_MNV_table_insert(self->table, len + 1, reference, start, end, allele_count, sample_id, phase, inserted);
+    vrd_MNV_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
+    if (0 != ret)
     {
         PyErr_SetString(PyExc_RuntimeError, "MNVTable.insert: vrd_MNV_table_insert() failed");
         return NULL;
@@ -112,7 +119,11 @@ MNVTable_remove(MNVTableObject* const self, PyObject* const args)
 
     size_t result = 0;
     Py_BEGIN_ALLOW_THREADS
+    vrd_MNV_table_lock(self->table);
+    vrd_Seq_table_lock(seq->table);
     result = vrd_MNV_table_remove_seq(self->table, subset, seq->table);
+    vrd_Seq_table_unlock(seq->table);
+    vrd_MNV_table_unlock(self->table);
     vrd_AVL_tree_destroy(&subset);
     Py_END_ALLOW_THREADS
 
@@ -120,6 +131,29 @@ MNVTable_remove(MNVTableObject* const self, PyObject* const args)
 } // MNVTable_remove
 
 
+static PyObject*
+MNVTable_compact(MNVTableObject* const self, PyObject* const args)
+{
+    SequenceTableObject* seq = NULL;
+
+    if (!PyArg_ParseTuple(args, "O!:MNVTable.compact", &SequenceTable, &seq))
+    {
+        return NULL;
+    } // if
+
+    size_t result = 0;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_MNV_table_lock(self->table);
+    vrd_Seq_table_lock(seq->table);
+    result = vrd_MNV_table_compact_seq(self->table, seq->table);
+    vrd_Seq_table_unlock(seq->table);
+    vrd_MNV_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
+    return Py_BuildValue("i", result);
+} // MNVTable_compact
+
+
 static PyObject*
 MNVTable_query_region(MNVTableObject* const self, PyObject* const args)
 {
@@ -217,6 +251,47 @@ MNVTable_query_region(MNVTableObject* const self, PyObject* const args)
 } // MNVTable_query_region
 
 
+static PyObject*
+MNVTable_query_region_count(MNVTableObject* const self, PyObject* const args)
+{
+    char const* reference = NULL;
+    size_t len = 0;
+    size_t start = 0;
+    size_t end = 0;
+    int homozygous = 0;
+    PyObject* list = NULL;
+
+    if (!PyArg_ParseTuple(args, "s#nn|pO!:MNVTable.query_region_count", &reference, &len, &start, &end, &homozygous, &PyList_Type, &list))
+    {
+        return NULL;
+    } // if
+
+    vrd_AVL_Tree* subset = NULL;
+    if (NULL != list)
+    {
+        subset = sample_set(list);
+        if (NULL == subset)
+        {
+            return NULL;
+        } // if
+    } // if
+
+    size_t result = 0;
+    Py_BEGIN_ALLOW_THREADS
+    result = vrd_MNV_table_query_region_count(self->table, len + 1, reference, start, end, homozygous != 0, subset);
+    vrd_AVL_tree_destroy(&subset);
+    Py_END_ALLOW_THREADS
+
+    if ((size_t) -1 == result)
+    {
+        PyErr_SetString(PyExc_ValueError, "MNVTable.query_region_count: reference not found");
+        return NULL;
+    } // if
+
+    return Py_BuildValue("i", result);
+} // MNVTable_query_region_count
+
+
 static PyObject*
 MNVTable_export(MNVTableObject* const self, PyObject* const args)
 {
@@ -291,6 +366,19 @@ static PyMethodDef MNVTable_methods[] =
      ":return: A list of MNVs containted in the query interval\n"
      ":rtype: list of dictionaries\n"},
 
+    {"query_region_count", (PyCFunction) MNVTable_query_region_count, METH_VARARGS,
+     "query_region_count(reference, start, end[, homozygous[, subset]])\n"
+     "Count the alleles of the MNVs that start in a region [start, end) in the\n"
+     ":py:class:`MNVTable`\n\n"
+     ":param string reference: The reference sequence ID\n"
+     ":param integer start: The start of the region\n"
+     ":param integer end: The end of the region\n"
+     ":param bool homozygous: Toggle to only count homozygous variants\n"
+     ":param subset: A list of sample IDs (`integer`), defaults to `None`\n"
+     ":type subset: list, optional\n"
+     ":return: The allele count of the MNVs in the query interval\n"
+     ":rtype: integer\n"},
+
     {"remove", (PyCFunction) MNVTable_remove, METH_VARARGS,
      "remove(subset, seq_table)\n"
      "Remove for MNVs in the :py:class:`MNVTable`\n\n"
@@ -301,19 +389,47 @@ static PyMethodDef MNVTable_methods[] =
      ":return: The number of removed MNVs\n"
      ":rtype: integer\n"},
 
+    {"retract", (PyCFunction) MNVTable_retract, METH_VARARGS,
+     "retract(sample_id)\n"
+     "Hide a sample from all queries on the :py:class:`MNVTable` until it is\n"
+     "removed by :py:meth:`compact`\n\n"
+     ":param integer sample_id: The sample ID\n"},
+
+    {"compact", (PyCFunction) MNVTable_compact, METH_VARARGS,
+     "compact(sequence_table)\n"
+     "Remove the retracted samples from the :py:class:`MNVTable`\n\n"
+     ":param sequence_table: The :py:class:`SequenceTable` of the inserted sequences\n"
+     ":return: The number of removed entries\n"
+     ":rtype: integer\n"},
+
     {"reorder", (PyCFunction) MNVTable_reorder, METH_NOARGS,
      "reorder()\n"
      "Reorders all structures in the :py:class:`MNVTable`\n\n"},
 
+    {"freeze", (PyCFunction) MNVTable_freeze, METH_NOARGS,
+     "freeze()\n"
+     "Makes the :py:class:`MNVTable` read-only in a compact layout for\n"
+     "faster queries\n\n"},
+
+    {"index", (PyCFunction) MNVTable_index, METH_NOARGS,
+     "index()\n"
+     "(Re)builds a read-only copy of the modified structures in the\n"
+     ":py:class:`MNVTable` for faster queries, until they are modified again\n\n"},
+
     {"read", (PyCFunction) MNVTable_read, METH_VARARGS,
      "read(path)\n"
-     "Read a :py:class:`MNVTable` from files\n\n"
-     ":param string path: A path including a prefix that identifies the files\n"},
+     "Read a :py:class:`MNVTable` from a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"},
+
+    {"map", (PyCFunction) MNVTable_map, METH_VARARGS,
+     "map(path)\n"
+     "Map a :py:class:`MNVTable` from a checkpoint file read-only into memory\n\n"
+     ":param string path: The path of the checkpoint file\n"},
 
     {"write", (PyCFunction) MNVTable_write, METH_VARARGS,
      "write(path)\n"
-     "Write a :py:class:`MNVTable` to files\n\n"
-     ":param string path: A path including a prefix that identifies the files\n"},
+     "Write a :py:class:`MNVTable` to a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"},
 
     {"export", (PyCFunction) MNVTable_export, METH_VARARGS,
      "export(path, seq_table)\n"
@@ -342,7 +458,7 @@ PyTypeObject MNVTable =
               "Table containing multi nucleotide variants (MNV).\n\n"
               ":param ref_capacity:  defaults to :c:data:`CFG_REF_CAPACITY`\n"
               ":type ref_capacity: integer, optional\n"
-              ":param tree_capacity:  defaults to :c:data:`CFG_REF_TREE_CAPACITY`\n"
+              ":param tree_capacity:  defaults to :c:data:`CFG_TREE_CAPACITY`, the initial number of entries per reference\n"
               ":type tree_capacity: integer, optional\n",
     .tp_basicsize = sizeof(MNVTableObject),
     .tp_itemsize = 0,
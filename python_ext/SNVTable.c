@@ -44,7 +44,14 @@ SNVTable_insert(SNVTableObject* const self, PyObject* const args)
         return NULL;
     } // if
 
-    if (0 != vrd_SNV_table_insert(self->table, len + 1, reference, position, allele_count, sample_id, phase, vrd_iupac_to_idx(inserted[0])))
+    int ret = 0;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_SNV_table_lock(self->table);
+    ret = vrd_SNV_table_insert(self->table, len + 1, reference, position, allele_count, sample_id, phase, vrd_iupac_to_idx(inserted[0]));
+    vrd_SNV_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
+    if (0 != ret)
     {
         PyErr_SetString(PyExc_RuntimeError, "SNVTable.insert: vrd_SNV_table_insert() failed");
         return NULL;
@@ -102,6 +109,110 @@ SNVTable_query(SNVTableObject* const self, PyObject* const args)
 } // SNVTable_query
 
 
+static PyObject*
+SNVTable_query_batch(SNVTableObject* const self, PyObject* const args)
+{
+    char const* reference = NULL;
+    size_t len = 0;
+    PyObject* variants = NULL;
+    int homozygous = 0;
+    PyObject* list = NULL;
+
+    if (!PyArg_ParseTuple(args, "s#O!|pO!:SNVTable.query_batch", &reference, &len, &PyList_Type, &variants, &homozygous, &PyList_Type, &list))
+    {
+        return NULL;
+    } // if
+
+    size_t const n = PyList_Size(variants);
+    if (0 == n)
+    {
+        return PyList_New(0);
+    } // if
+
+    // FIXME: overflow
+    size_t* const position = malloc(3 * n * sizeof(*position));
+    if (NULL == position)
+    {
+        return PyErr_NoMemory();
+    } // if
+    size_t* const inserted = position + n;
+    size_t* const count = inserted + n;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        char const* nucleotide = NULL;
+        size_t len_inserted = 0;
+        if (!PyArg_ParseTuple(PyList_GetItem(variants, i), "ns#:SNVTable.query_batch", &position[i], &nucleotide, &len_inserted))
+        {
+            free(position);
+            return NULL;
+        } // if
+
+        if (1 != len_inserted)
+        {
+            free(position);
+            PyErr_SetString(PyExc_ValueError, "SNVTable.query_batch: expected one inserted nucleotide");
+            return NULL;
+        } // if
+        inserted[i] = vrd_iupac_to_idx(nucleotide[0]);
+    } // for
+
+    vrd_AVL_Tree* subset = NULL;
+    if (NULL != list)
+    {
+        subset = sample_set(list);
+        if (NULL == subset)
+        {
+            free(position);
+            return NULL;
+        } // if
+    } // if
+
+    int ret = 0;
+    Py_BEGIN_ALLOW_THREADS
+    ret = vrd_SNV_table_query_batch(self->table, len + 1, reference, n, position, inserted, homozygous != 0, subset, count);
+    vrd_AVL_tree_destroy(&subset);
+    Py_END_ALLOW_THREADS
+
+    if (0 != ret)
+    {
+        free(position);
+        PyErr_SetString(PyExc_ValueError, "SNVTable.query_batch: reference not found");
+        return NULL;
+    } // if
+
+    PyObject* const result = PyList_New(n);
+    if (NULL == result)
+    {
+        free(position);
+        return PyErr_NoMemory();
+    } // if
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        PyObject* const item = PyLong_FromSize_t(count[i]);
+        if (NULL == item)
+        {
+            Py_DECREF(result);
+            free(position);
+            return PyErr_NoMemory();
+        } // if
+
+        if (0 != PyList_SetItem(result, i, item))
+        {
+            Py_DECREF(item);
+            Py_DECREF(result);
+            free(position);
+            return PyErr_NoMemory();
+        } // if
+    } // for
+
+    free(position);
+
+    return result;
+} // SNVTable_query_batch
+
+
 static PyObject*
 SNVTable_query_region(SNVTableObject* const self, PyObject* const args)
 {
@@ -193,6 +304,47 @@ SNVTable_query_region(SNVTableObject* const self, PyObject* const args)
 } // SNVTable_query_region
 
 
+static PyObject*
+SNVTable_query_region_count(SNVTableObject* const self, PyObject* const args)
+{
+    char const* reference = NULL;
+    size_t len = 0;
+    size_t start = 0;
+    size_t end = 0;
+    int homozygous = 0;
+    PyObject* list = NULL;
+
+    if (!PyArg_ParseTuple(args, "s#nn|pO!:SNVTable.query_region_count", &reference, &len, &start, &end, &homozygous, &PyList_Type, &list))
+    {
+        return NULL;
+    } // if
+
+    vrd_AVL_Tree* subset = NULL;
+    if (NULL != list)
+    {
+        subset = sample_set(list);
+        if (NULL == subset)
+        {
+            return NULL;
+        } // if
+    } // if
+
+    size_t result = 0;
+    Py_BEGIN_ALLOW_THREADS
+    result = vrd_SNV_table_query_region_count(self->table, len + 1, reference, start, end, homozygous != 0, subset);
+    vrd_AVL_tree_destroy(&subset);
+    Py_END_ALLOW_THREADS
+
+    if ((size_t) -1 == result)
+    {
+        PyErr_SetString(PyExc_ValueError, "SNVTable.query_region_count: reference not found");
+        return NULL;
+    } // if
+
+    return Py_BuildValue("i", result);
+} // SNVTable_query_region_count
+
+
 static PyObject*
 SNVTable_remove(SNVTableObject* const self, PyObject* const args)
 {
@@ -211,7 +363,9 @@ SNVTable_remove(SNVTableObject* const self, PyObject* const args)
 
     size_t result = 0;
     Py_BEGIN_ALLOW_THREADS
+    vrd_SNV_table_lock(self->table);
     result = vrd_SNV_table_remove(self->table, subset);
+    vrd_SNV_table_unlock(self->table);
     vrd_AVL_tree_destroy(&subset);
     Py_END_ALLOW_THREADS
 
@@ -219,6 +373,22 @@ SNVTable_remove(SNVTableObject* const self, PyObject* const args)
 } // SNVTable_remove
 
 
+static PyObject*
+SNVTable_compact(SNVTableObject* const self, PyObject* const args)
+{
+    (void) args;
+
+    size_t result = 0;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_SNV_table_lock(self->table);
+    result = vrd_SNV_table_compact(self->table);
+    vrd_SNV_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
+    return Py_BuildValue("i", result);
+} // SNVTable_compact
+
+
 static PyObject*
 SNVTable_export(SNVTableObject* const self, PyObject* const args)
 {
@@ -276,6 +446,18 @@ static PyMethodDef SNVTable_methods[] =
      ":return: The number of contained SNVs\n"
      ":rtype: integer\n"},
 
+    {"query_batch", (PyCFunction) SNVTable_query_batch, METH_VARARGS,
+     "query_batch(reference, variants[, homozygous[, subset]])\n"
+     "Query for many SNVs on a reference in the :py:class:`SNVTable` at once\n\n"
+     ":param string reference: The reference sequence ID\n"
+     ":param variants: A list of (position, inserted) tuples\n"
+     ":type variants: list\n"
+     ":param bool homozygous: Toggle to only count homozygous variants\n"
+     ":param subset: A list of sample IDs (`integer`), defaults to `None`\n"
+     ":type subset: list, optional\n"
+     ":return: The number of contained SNVs for each of the variants\n"
+     ":rtype: list of integers\n"},
+
     {"query_region", (PyCFunction) SNVTable_query_region, METH_VARARGS,
      "query_region(reference, start, end, size[, subset])\n"
      "Query for SNVs in a region [start, end) in the :py:class:`SNVTable`\n\n"
@@ -288,6 +470,19 @@ static PyMethodDef SNVTable_methods[] =
      ":return: A list of SNVs containted in the query interval\n"
      ":rtype: list of dictionaries\n"},
 
+    {"query_region_count", (PyCFunction) SNVTable_query_region_count, METH_VARARGS,
+     "query_region_count(reference, start, end[, homozygous[, subset]])\n"
+     "Count the alleles of the SNVs in a region [start, end) in the\n"
+     ":py:class:`SNVTable`\n\n"
+     ":param string reference: The reference sequence ID\n"
+     ":param integer start: The start of the region\n"
+     ":param integer end: The end of the region\n"
+     ":param bool homozygous: Toggle to only count homozygous variants\n"
+     ":param subset: A list of sample IDs (`integer`), defaults to `None`\n"
+     ":type subset: list, optional\n"
+     ":return: The allele count of the SNVs in the query interval\n"
+     ":rtype: integer\n"},
+
     {"remove", (PyCFunction) SNVTable_remove, METH_VARARGS,
      "remove(subset)\n"
      "Remove for SNVs in the :py:class:`SNVTable`\n\n"
@@ -296,19 +491,46 @@ static PyMethodDef SNVTable_methods[] =
      ":return: The number of removed SNVs\n"
      ":rtype: integer\n"},
 
+    {"retract", (PyCFunction) SNVTable_retract, METH_VARARGS,
+     "retract(sample_id)\n"
+     "Hide a sample from all queries on the :py:class:`SNVTable` until it is\n"
+     "removed by :py:meth:`compact`\n\n"
+     ":param integer sample_id: The sample ID\n"},
+
+    {"compact", (PyCFunction) SNVTable_compact, METH_NOARGS,
+     "compact()\n"
+     "Remove the retracted samples from the :py:class:`SNVTable`\n\n"
+     ":return: The number of removed entries\n"
+     ":rtype: integer\n"},
+
     {"reorder", (PyCFunction) SNVTable_reorder, METH_NOARGS,
      "reorder()\n"
      "Reorders all structures in the :py:class:`SNVTable`\n\n"},
 
+    {"freeze", (PyCFunction) SNVTable_freeze, METH_NOARGS,
+     "freeze()\n"
+     "Makes the :py:class:`SNVTable` read-only in a compact layout for\n"
+     "faster queries\n\n"},
+
+    {"index", (PyCFunction) SNVTable_index, METH_NOARGS,
+     "index()\n"
+     "(Re)builds a read-only copy of the modified structures in the\n"
+     ":py:class:`SNVTable` for faster queries, until they are modified again\n\n"},
+
     {"read", (PyCFunction) SNVTable_read, METH_VARARGS,
      "read(path)\n"
-     "Read a :py:class:`SNVTable` from files\n\n"
-     ":param string path: A path including a prefix that identifies the files\n"},
+     "Read a :py:class:`SNVTable` from a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"},
+
+    {"map", (PyCFunction) SNVTable_map, METH_VARARGS,
+     "map(path)\n"
+     "Map a :py:class:`SNVTable` from a checkpoint file read-only into memory\n\n"
+     ":param string path: The path of the checkpoint file\n"},
 
     {"write", (PyCFunction) SNVTable_write, METH_VARARGS,
      "write(path)\n"
-     "Write a :py:class:`SNVTable` to files\n\n"
-     ":param string path: A path including a prefix that identifies the files\n"},
+     "Write a :py:class:`SNVTable` to a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"},
 
     {"export", (PyCFunction) SNVTable_export, METH_VARARGS,
      "export(path, seq_table)\n"
@@ -335,7 +557,7 @@ PyTypeObject SNVTable =
               "Table containing single nucleotide variants (SNV).\n\n"
               ":param ref_capacity:  defaults to :c:data:`CFG_REF_CAPACITY`\n"
               ":type ref_capacity: integer, optional\n"
-              ":param tree_capacity:  defaults to :c:data:`CFG_REF_TREE_CAPACITY`\n"
+              ":param tree_capacity:  defaults to :c:data:`CFG_TREE_CAPACITY`, the initial number of entries per reference\n"
               ":type tree_capacity: integer, optional\n",
     .tp_basicsize = sizeof(SNVTableObject),
     .tp_itemsize = 0,
@@ -56,7 +56,13 @@ SequenceTable_insert(SequenceTableObject* const self, PyObject* const args)
         return NULL;
     } // if
 
-    vrd_Trie_Node* const result = vrd_Seq_table_insert(self->table, len + 1, sequence);
+    vrd_Trie_Node* result = NULL;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_Seq_table_lock(self->table);
+    result = vrd_Seq_table_insert(self->table, len + 1, sequence);
+    vrd_Seq_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
     if (NULL == result)
     {
         PyErr_SetString(PyExc_RuntimeError, "SequenceTable.insert: vrd_Seq_table_insert() failed");
@@ -98,7 +104,14 @@ SequenceTable_remove(SequenceTableObject* const self, PyObject* const args)
         return NULL;
     } // if
 
-    if (0 != vrd_Seq_table_remove(self->table, elem))
+    int ret = 0;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_Seq_table_lock(self->table);
+    ret = vrd_Seq_table_remove(self->table, elem);
+    vrd_Seq_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
+    if (0 != ret)
     {
         PyErr_SetString(PyExc_RuntimeError, "SequenceTable.remove: vrd_Seq_table_remove() failed");
         return NULL;
@@ -118,7 +131,14 @@ SequenceTable_read(SequenceTableObject* const self, PyObject* const args)
         return NULL;
     } // if
 
-    if (0 != vrd_Seq_table_read(self->table, path))
+    int ret = 0;
+    Py_BEGIN_ALLOW_THREADS
+    vrd_Seq_table_lock(self->table);
+    ret = vrd_Seq_table_read(self->table, path);
+    vrd_Seq_table_unlock(self->table);
+    Py_END_ALLOW_THREADS
+
+    if (0 != ret)
     {
         PyErr_SetString(PyExc_RuntimeError, "SequenceTable.read: vrd_Seq_table_read() failed");
         return NULL;
@@ -197,13 +217,13 @@ static PyMethodDef SequenceTable_methods[] =
 
     {"read", (PyCFunction) SequenceTable_read, METH_VARARGS,
      "read(path)\n"
-     "Read a :py:class:`SequenceTable` from files\n\n"
-     ":param string path: A path including a prefix that identifies the files.\n"},
+     "Read a :py:class:`SequenceTable` from a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file.\n"},
 
     {"write", (PyCFunction) SequenceTable_write, METH_VARARGS,
      "write(path)\n"
-     "Write a :py:class:`SequenceTable` to files\n\n"
-     ":param string path: A path including a prefix that identifies the files.\n"},
+     "Write a :py:class:`SequenceTable` to a checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file.\n"},
 
     {"diagnostics", (PyCFunction) SequenceTable_diagnostics, METH_NOARGS,
      "diagnostics()\n"
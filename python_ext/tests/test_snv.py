@@ -26,3 +26,47 @@ def test_snv_entries():
 
     diag = mnv_table.diagnostics()
     assert diag == {'chr1': {'height': 1, 'entry_size': 32, 'entries': 1}}
+
+
+def test_snv_query_region_count():
+    snv_table = cvarda.SNVTable()
+
+    for position in range(100):
+        snv_table.insert('chr1', position, 1 + position % 2, position % 3, "A", -1 if position % 5 == 0 else 1)
+
+    assert snv_table.query_region_count('chr1', 0, 100) == 150
+    assert snv_table.query_region_count('chr1', 10, 20) == 15
+    assert snv_table.query_region_count('chr1', 10, 20, True) == 3
+    assert snv_table.query_region_count('chr1', 10, 20, False, [0]) == 4
+
+
+def test_snv_retract():
+    snv_table = cvarda.SNVTable()
+
+    for position in range(100):
+        snv_table.insert('chr1', position, 1, position % 3, "A", 1)
+
+    snv_table.retract(0)
+    assert snv_table.query('chr1', 30, "A") == 0
+    assert snv_table.query('chr1', 31, "A") == 1
+    assert snv_table.query_region_count('chr1', 0, 100) == 66
+    assert snv_table.diagnostics()['chr1']['entries'] == 100
+
+    assert snv_table.compact() == 34
+    assert snv_table.compact() == 0
+    assert snv_table.query_region_count('chr1', 0, 100) == 66
+    assert snv_table.diagnostics()['chr1']['entries'] == 66
+
+
+def test_snv_query_batch():
+    snv_table = cvarda.SNVTable()
+
+    for sample_id in range(300):
+        snv_table.insert('chr1', 10 + sample_id % 3, 1, sample_id, "ACGT"[sample_id % 4], 1)
+
+    variants = [(position, inserted) for position in range(9, 14) for inserted in "ACGT"]
+    expected = [snv_table.query('chr1', position, inserted) for position, inserted in variants]
+    assert snv_table.query_batch('chr1', variants) == expected
+    assert sum(expected) == 300
+    assert snv_table.query_batch('chr1', variants, False, [0, 1]) == [snv_table.query('chr1', position, inserted, False, [0, 1]) for position, inserted in variants]
+    assert snv_table.query_batch('chr1', []) == []
@@ -12,7 +12,8 @@
 
 static size_t const CFG_REF_CAPACITY = 1000;
 static size_t const CFG_SEQ_CAPACITY = 100000;
-static size_t const CFG_TREE_CAPACITY = 1 << 24;
+static size_t const CFG_TREE_CAPACITY = 1 << 10;   // initial, trees grow
+                                                    // on demand
 
 
 vrd_AVL_Tree*
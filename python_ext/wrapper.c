@@ -23,8 +23,9 @@ coverage_from_file(PyObject* const self, PyObject* const args)
     char const* path = NULL;
     int sample_id = 0;
     CoverageTableObject* cov = NULL;
+    char const* wal_path = NULL;
 
-    if (!PyArg_ParseTuple(args, "siO!:coverage_from_file", &path, &sample_id, &CoverageTable, &cov))
+    if (!PyArg_ParseTuple(args, "siO!|z:coverage_from_file", &path, &sample_id, &CoverageTable, &cov, &wal_path))
     {
         return NULL;
     } // if
@@ -36,13 +37,33 @@ coverage_from_file(PyObject* const self, PyObject* const args)
         return PyErr_SetFromErrno(PyExc_OSError);
     } // if
 
+    vrd_WAL* wal = NULL;
+    if (NULL != wal_path)
+    {
+        errno = 0;
+        wal = vrd_wal_open(wal_path, 0);
+        if (NULL == wal)
+        {
+            PyErr_SetFromErrno(PyExc_OSError);
+            fclose(stream);
+            return NULL;
+        } // if
+    } // if
+
     size_t count = 0;
     Py_BEGIN_ALLOW_THREADS
-    count = vrd_coverage_from_file(stream, cov->table, sample_id);
+    count = vrd_coverage_from_file(stream, cov->table, sample_id, wal);
     Py_END_ALLOW_THREADS
 
     errno = 0;
     if (0 != fclose(stream))
+    {
+        vrd_wal_close(&wal);
+        return PyErr_SetFromErrno(PyExc_OSError);
+    } // if
+
+    errno = vrd_wal_close(&wal);
+    if (0 != errno)
     {
         return PyErr_SetFromErrno(PyExc_OSError);
     } // if
@@ -61,8 +82,9 @@ variants_from_file(PyObject* const self, PyObject* const args)
     SNVTableObject* snv = NULL;
     MNVTableObject* mnv = NULL;
     SequenceTableObject* seq = NULL;
+    char const* wal_path = NULL;
 
-    if (!PyArg_ParseTuple(args, "siO!O!O!:variants_from_file", &path, &sample_id, &SNVTable, &snv, &MNVTable, &mnv, &SequenceTable, &seq))
+    if (!PyArg_ParseTuple(args, "siO!O!O!|z:variants_from_file", &path, &sample_id, &SNVTable, &snv, &MNVTable, &mnv, &SequenceTable, &seq, &wal_path))
     {
         return NULL;
     } // if
@@ -74,13 +96,33 @@ variants_from_file(PyObject* const self, PyObject* const args)
         return PyErr_SetFromErrno(PyExc_OSError);
     } // if
 
+    vrd_WAL* wal = NULL;
+    if (NULL != wal_path)
+    {
+        errno = 0;
+        wal = vrd_wal_open(wal_path, 0);
+        if (NULL == wal)
+        {
+            PyErr_SetFromErrno(PyExc_OSError);
+            fclose(stream);
+            return NULL;
+        } // if
+    } // if
+
     size_t count = 0;
     Py_BEGIN_ALLOW_THREADS
-    count = vrd_variants_from_file(stream, snv->table, mnv->table, seq->table, sample_id);
+    count = vrd_variants_from_file(stream, snv->table, mnv->table, seq->table, sample_id, wal);
     Py_END_ALLOW_THREADS
 
     errno = 0;
     if (0 != fclose(stream))
+    {
+        vrd_wal_close(&wal);
+        return PyErr_SetFromErrno(PyExc_OSError);
+    } // if
+
+    errno = vrd_wal_close(&wal);
+    if (0 != errno)
     {
         return PyErr_SetFromErrno(PyExc_OSError);
     } // if
@@ -230,20 +272,282 @@ sample_count(PyObject* const self, PyObject* const args)
 } // sample_count
 
 
+static PyObject*
+database_read(PyObject* const self, PyObject* const args)
+{
+    (void) self;
+
+    char const* path = NULL;
+    CoverageTableObject* cov = NULL;
+    SNVTableObject* snv = NULL;
+    MNVTableObject* mnv = NULL;
+    SequenceTableObject* seq = NULL;
+    int mapped = 0;
+    Py_ssize_t threads = 1;
+
+    if (!PyArg_ParseTuple(args, "sO!O!O!O!|pn:database_read", &path, &CoverageTable, &cov, &SNVTable, &snv, &MNVTable, &mnv, &SequenceTable, &seq, &mapped, &threads))
+    {
+        return NULL;
+    } // if
+
+    if (1 > threads)
+    {
+        PyErr_SetString(PyExc_ValueError, "threads must be positive");
+        return NULL;
+    } // if
+
+    int err = 0;
+    Py_BEGIN_ALLOW_THREADS
+    if (mapped)
+    {
+        err = vrd_database_map(path, cov->table, snv->table, mnv->table, seq->table, threads);
+    } // if
+    else
+    {
+        err = vrd_database_read(path, cov->table, snv->table, mnv->table, seq->table, threads);
+    } // else
+    Py_END_ALLOW_THREADS
+
+    if (0 != err)
+    {
+        if (err < 0)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "database_read failed");
+        } // if
+        else
+        {
+            errno = err;
+            PyErr_SetFromErrno(PyExc_OSError);
+        } // else
+        return NULL;
+    } // if
+
+    Py_RETURN_NONE;
+} // database_read
+
+
+static PyObject*
+database_write(PyObject* const self, PyObject* const args)
+{
+    (void) self;
+
+    char const* path = NULL;
+    CoverageTableObject* cov = NULL;
+    SNVTableObject* snv = NULL;
+    MNVTableObject* mnv = NULL;
+    SequenceTableObject* seq = NULL;
+    int packed = 0;
+    int incremental = 0;
+    Py_ssize_t threads = 1;
+
+    if (!PyArg_ParseTuple(args, "sO!O!O!O!|ppn:database_write", &path, &CoverageTable, &cov, &SNVTable, &snv, &MNVTable, &mnv, &SequenceTable, &seq, &packed, &incremental, &threads))
+    {
+        return NULL;
+    } // if
+
+    if (1 > threads)
+    {
+        PyErr_SetString(PyExc_ValueError, "threads must be positive");
+        return NULL;
+    } // if
+
+    unsigned int const flags = (packed ? VRD_CHECKPOINT_PACK : 0) |
+                               (incremental ? VRD_CHECKPOINT_INCREMENTAL : 0);
+
+    int err = 0;
+    Py_BEGIN_ALLOW_THREADS
+    err = vrd_database_write(path, cov->table, snv->table, mnv->table, seq->table, flags, threads);
+    Py_END_ALLOW_THREADS
+
+    if (0 != err)
+    {
+        if (err < 0)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "database_write failed");
+        } // if
+        else
+        {
+            errno = err;
+            PyErr_SetFromErrno(PyExc_OSError);
+        } // else
+        return NULL;
+    } // if
+
+    Py_RETURN_NONE;
+} // database_write
+
+
+static PyObject*
+database_snapshot(PyObject* const self, PyObject* const args)
+{
+    (void) self;
+
+    char const* path = NULL;
+    CoverageTableObject* cov = NULL;
+    SNVTableObject* snv = NULL;
+    MNVTableObject* mnv = NULL;
+    SequenceTableObject* seq = NULL;
+    int packed = 0;
+
+    if (!PyArg_ParseTuple(args, "sO!O!O!O!|p:database_snapshot", &path, &CoverageTable, &cov, &SNVTable, &snv, &MNVTable, &mnv, &SequenceTable, &seq, &packed))
+    {
+        return NULL;
+    } // if
+
+    // the forked writer does not run any Python code; the fork waits for
+    // the imports in progress
+    pid_t pid = 0;
+    Py_BEGIN_ALLOW_THREADS
+    pid = vrd_database_snapshot(path, cov->table, snv->table, mnv->table, seq->table, packed ? VRD_CHECKPOINT_PACK : 0);
+    Py_END_ALLOW_THREADS
+    if (0 > pid)
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return NULL;
+    } // if
+
+    return Py_BuildValue("l", (long) pid);
+} // database_snapshot
+
+
+static PyObject*
+snapshot_wait(PyObject* const self, PyObject* const args)
+{
+    (void) self;
+
+    long pid = 0;
+
+    if (!PyArg_ParseTuple(args, "l:snapshot_wait", &pid))
+    {
+        return NULL;
+    } // if
+
+    int err = 0;
+    Py_BEGIN_ALLOW_THREADS
+    err = vrd_snapshot_wait(pid);
+    Py_END_ALLOW_THREADS
+
+    if (0 != err)
+    {
+        if (err < 0)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "database_snapshot failed");
+        } // if
+        else
+        {
+            errno = err;
+            PyErr_SetFromErrno(PyExc_OSError);
+        } // else
+        return NULL;
+    } // if
+
+    Py_RETURN_NONE;
+} // snapshot_wait
+
+
+static PyObject*
+wal_replay(PyObject* const self, PyObject* const args)
+{
+    (void) self;
+
+    char const* path = NULL;
+    char const* checkpoint = NULL;
+    CoverageTableObject* cov = NULL;
+    SNVTableObject* snv = NULL;
+    MNVTableObject* mnv = NULL;
+    SequenceTableObject* seq = NULL;
+
+    if (!PyArg_ParseTuple(args, "szO!O!O!O!:wal_replay", &path, &checkpoint, &CoverageTable, &cov, &SNVTable, &snv, &MNVTable, &mnv, &SequenceTable, &seq))
+    {
+        return NULL;
+    } // if
+
+    size_t count = 0;
+    int err = 0;
+    Py_BEGIN_ALLOW_THREADS
+    err = vrd_wal_replay(path, checkpoint, cov->table, snv->table, mnv->table, seq->table, &count);
+    Py_END_ALLOW_THREADS
+
+    if (0 != err)
+    {
+        if (err < 0)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "wal_replay failed");
+        } // if
+        else
+        {
+            errno = err;
+            PyErr_SetFromErrno(PyExc_OSError);
+        } // else
+        return NULL;
+    } // if
+
+    return Py_BuildValue("n", (Py_ssize_t) count);
+} // wal_replay
+
+
+static PyObject*
+wal_reset(PyObject* const self, PyObject* const args)
+{
+    (void) self;
+
+    char const* path = NULL;
+    char const* checkpoint = NULL;
+
+    if (!PyArg_ParseTuple(args, "sz:wal_reset", &path, &checkpoint))
+    {
+        return NULL;
+    } // if
+
+    errno = 0;
+    vrd_WAL* wal = vrd_wal_open(path, 0);
+    if (NULL == wal)
+    {
+        return PyErr_SetFromErrno(PyExc_OSError);
+    } // if
+
+    int err = vrd_wal_reset(wal, checkpoint);
+    int const ret = vrd_wal_close(&wal);
+    if (0 == err)
+    {
+        err = ret;
+    } // if
+
+    if (0 != err)
+    {
+        if (err < 0)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "wal_reset failed");
+        } // if
+        else
+        {
+            errno = err;
+            PyErr_SetFromErrno(PyExc_OSError);
+        } // else
+        return NULL;
+    } // if
+
+    Py_RETURN_NONE;
+} // wal_reset
+
+
 static PyMethodDef methods[] =
 {
     {"coverage_from_file", (PyCFunction) coverage_from_file, METH_VARARGS,
-     "coverage_from_file(path, sample_id, cov_table)\n"
+     "coverage_from_file(path, sample_id, cov_table[, wal])\n"
      "Import covered regions for a given sample from a file\n\n"
      ":param string path: The file path\n"
      ":param int sample_id: The sample ID\n"
      ":param cov_table: The coverage table\n"
      ":type cov_table: :py:class:`CoverageTable`\n"
+     ":param wal: The path of a write-ahead log to append the regions to,\n"
+     "            defaults to `None`\n"
+     ":type wal: string, optional\n"
      ":return: The number of inserted covered regions\n"
      ":rtype: integer\n"},
 
     {"variants_from_file", (PyCFunction) variants_from_file, METH_VARARGS,
-     "variants_from_file(path, sample_id, snv_table, mnv_table, seq_table)\n"
+     "variants_from_file(path, sample_id, snv_table, mnv_table, seq_table[, wal])\n"
      "Import variants for a given sample from a file\n\n"
      ":param string path: The file path\n"
      ":param int sample_id: The sample ID\n"
@@ -253,6 +557,9 @@ static PyMethodDef methods[] =
      ":type mnv_table: :py:class:`MNVTable`\n"
      ":param seq_table: The Sequence table\n"
      ":type seq_table: :py:class:`SequenceTable`\n"
+     ":param wal: The path of a write-ahead log to append the variants to,\n"
+     "            defaults to `None`\n"
+     ":type wal: string, optional\n"
      ":return: The number of inserted variants\n"
      ":rtype: integer\n"},
 
@@ -286,6 +593,99 @@ static PyMethodDef methods[] =
      ":return: A list of entry counts per sample ID\n"
      ":rtype: list of integers\n"},
 
+    {"database_read", (PyCFunction) database_read, METH_VARARGS,
+     "database_read(path, cov_table, snv_table, mnv_table, seq_table[, mapped[, threads]])\n"
+     "Read all tables of the database from a single checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"
+     ":param cov_table: The coverage table\n"
+     ":type cov_table: :py:class:`CoverageTable`\n"
+     ":param snv_table: The SNV table\n"
+     ":type snv_table: :py:class:`SNVTable`\n"
+     ":param mnv_table: The MNV table\n"
+     ":type mnv_table: :py:class:`MNVTable`\n"
+     ":param seq_table: The Sequence table\n"
+     ":type seq_table: :py:class:`SequenceTable`\n"
+     ":param mapped: Map the trees read-only into memory, defaults to `False`\n"
+     ":type mapped: bool, optional\n"
+     ":param threads: The number of threads that load the trees, defaults\n"
+     "                to 1\n"
+     ":type threads: integer, optional\n"},
+
+    {"database_write", (PyCFunction) database_write, METH_VARARGS,
+     "database_write(path, cov_table, snv_table, mnv_table, seq_table[, packed[, incremental[, threads]]])\n"
+     "Write all tables of the database to a single checkpoint file\n\n"
+     ":param string path: The path of the checkpoint file\n"
+     ":param cov_table: The coverage table\n"
+     ":type cov_table: :py:class:`CoverageTable`\n"
+     ":param snv_table: The SNV table\n"
+     ":type snv_table: :py:class:`SNVTable`\n"
+     ":param mnv_table: The MNV table\n"
+     ":type mnv_table: :py:class:`MNVTable`\n"
+     ":param seq_table: The Sequence table\n"
+     ":type seq_table: :py:class:`SequenceTable`\n"
+     ":param packed: Write the trees in a compact encoding that cannot be\n"
+     "               mapped, defaults to `False`\n"
+     ":type packed: bool, optional\n"
+     ":param incremental: Only write the trees that changed since the tables\n"
+     "                    were last read from or written to this checkpoint,\n"
+     "                    defaults to `False`\n"
+     ":type incremental: bool, optional\n"
+     ":param threads: The number of threads that store the trees, defaults\n"
+     "                to 1\n"
+     ":type threads: integer, optional\n"},
+
+    {"database_snapshot", (PyCFunction) database_snapshot, METH_VARARGS,
+     "database_snapshot(path, cov_table, snv_table, mnv_table, seq_table[, packed])\n"
+     "Write all tables of the database as they are now to a single\n"
+     "checkpoint file in a background process, while the tables can be\n"
+     "modified\n\n"
+     ":param string path: The path of the checkpoint file\n"
+     ":param cov_table: The coverage table\n"
+     ":type cov_table: :py:class:`CoverageTable`\n"
+     ":param snv_table: The SNV table\n"
+     ":type snv_table: :py:class:`SNVTable`\n"
+     ":param mnv_table: The MNV table\n"
+     ":type mnv_table: :py:class:`MNVTable`\n"
+     ":param seq_table: The Sequence table\n"
+     ":type seq_table: :py:class:`SequenceTable`\n"
+     ":param packed: Write the trees in a compact encoding that cannot be\n"
+     "               mapped, defaults to `False`\n"
+     ":type packed: bool, optional\n"
+     ":return: The process ID of the writer\n"
+     ":rtype: integer\n"},
+
+    {"snapshot_wait", (PyCFunction) snapshot_wait, METH_VARARGS,
+     "snapshot_wait(pid)\n"
+     "Wait for a background snapshot to finish\n\n"
+     ":param int pid: The process ID of the writer\n"},
+
+    {"wal_replay", (PyCFunction) wal_replay, METH_VARARGS,
+     "wal_replay(path, checkpoint, cov_table, snv_table, mnv_table, seq_table)\n"
+     "Replay a write-ahead log on top of the tables read from a checkpoint\n"
+     "file; a log that is not based on that checkpoint is skipped\n\n"
+     ":param string path: The path of the log\n"
+     ":param checkpoint: The path of the checkpoint file, or `None` for\n"
+     "                   empty tables\n"
+     ":type checkpoint: string or None\n"
+     ":param cov_table: The coverage table\n"
+     ":type cov_table: :py:class:`CoverageTable`\n"
+     ":param snv_table: The SNV table\n"
+     ":type snv_table: :py:class:`SNVTable`\n"
+     ":param mnv_table: The MNV table\n"
+     ":type mnv_table: :py:class:`MNVTable`\n"
+     ":param seq_table: The Sequence table\n"
+     ":type seq_table: :py:class:`SequenceTable`\n"
+     ":return: The number of replayed records\n"
+     ":rtype: integer\n"},
+
+    {"wal_reset", (PyCFunction) wal_reset, METH_VARARGS,
+     "wal_reset(path, checkpoint)\n"
+     "Empty a write-ahead log after the tables were written to a checkpoint\n"
+     "file, and base the log on that checkpoint\n\n"
+     ":param string path: The path of the log\n"
+     ":param checkpoint: The path of the checkpoint file\n"
+     ":type checkpoint: string or None\n"},
+
     {NULL, NULL, 0, NULL}  // sentinel
 }; // methods
 
@@ -17,21 +17,26 @@ cvarda = Extension('ext',
                             'python_ext/SequenceTable.c',
                             'python_ext/SNVTable.c',
                             'src/avl_tree.c',
+                            'src/checkpoint.c',
                             'src/cov_table.c',
                             'src/cov_tree.c',
+                            'src/depth_tree.c',
                             'src/mnv_table.c',
                             'src/mnv_tree.c',
                             'src/seq_table.c',
                             'src/snv_table.c',
                             'src/snv_tree.c',
                             'src/trie.c',
-                            'src/utils.c'],
+                            'src/utils.c',
+                            'src/wal.c'],
                    define_macros=[('VRD_VERSION_MAJOR', VERSION_MAJOR),
                                   ('VRD_VERSION_MINOR', VERSION_MINOR),
                                   ('VRD_VERSION_PATCH', VERSION_PATCH)],
                    extra_compile_args=['-Wextra',
                                        '-Wpedantic',
-                                       '-std=c99'])
+                                       '-std=c99',
+                                       '-pthread'],
+                   extra_link_args=['-pthread'])
 
 
 setup(name='cvarda',
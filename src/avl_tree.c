@@ -1,11 +1,13 @@
 #include <assert.h>     // assert
 #include <stdbool.h>    // bool, false, true
 #include <stddef.h>     // NULL, size_t
-#include <stdint.h>     // UINT32_MAX, int32_t, uint32_t
+#include <stdint.h>     // UINT32_MAX, int32_t, uint32_t, uint64_t
+#include <stdlib.h>     // free, realloc
 
 #include "../include/avl_tree.h"    // vrd_AVL_Tree, vrd_AVL_tree_*
 #include "../include/template.h"    // VRD_TEMPLATE
-#include "tree.h"   // NULLPTR, LEFT, RIGHT
+#include "imath.h"  // umax, umin
+#include "tree.h"   // NULLPTR, LEFT, RIGHT, VRD_STACK_SIZE
 
 
 #define VRD_TYPENAME AVL
@@ -20,7 +22,94 @@ struct VRD_TEMPLATE(VRD_TYPENAME, _Node)
 }; // vrd_AVL_Node
 
 
-#include "template_tree.inc"    // vrd_AVL_tree_*, insert
+// a node of a frozen tree (see: vrd_AVL_tree_freeze)
+struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)
+{
+    uint32_t key;
+    uint32_t sample_id;     // unused
+}; // vrd_AVL_Frozen
+
+
+static inline void
+node_freeze(struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)* const frozen,
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node)
+{
+    frozen->key = node->key;
+    frozen->sample_id = node->sample_id;
+} // node_freeze
+
+
+// the fields of a packed node: key, sample_id
+#define VRD_FIELDS 2
+
+
+static inline void
+node_pack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node,
+          uint32_t field[VRD_FIELDS])
+{
+    field[0] = node->key;
+    field[1] = node->sample_id;
+} // node_pack
+
+
+static inline void
+node_unpack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node)* const node,
+            uint32_t const field[VRD_FIELDS])
+{
+    node->key = field[0];
+    node->sample_id = field[1];
+} // node_unpack
+
+
+// sample IDs are dense: their membership is kept in a bitset as well
+#define VRD_SET
+
+
+#include "template_tree.inc"    // vrd_AVL_tree_*, grow, insert
+#undef VRD_FIELDS
+#undef VRD_SET
+
+
+// A bitset grows up to 64 bits per key beyond a base of 64 Kib; sparser
+// sets (e.g., of huge keys) are only kept in the tree
+static size_t const BITSET_BASE = 1024;
+
+
+static void
+bitset_add(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self, size_t const key)
+{
+    // the bitset is only kept while it tracks every change of the tree
+    if (self->bitset_generation + 1 != self->base.generation)
+    {
+        return;
+    } // if
+    self->bitset_generation = self->base.generation;
+
+    size_t const word = key / 64;
+    if (self->words <= word)
+    {
+        size_t const words = umax(word + 1, self->words * 2);
+        uint64_t* const bits = words <= BITSET_BASE + self->base.entries ?
+                               realloc(self->bits, sizeof(bits[0]) * words) : NULL;
+        if (NULL == bits)
+        {
+            free(self->bits);
+            self->bits = NULL;
+            self->words = 0;
+            self->bitset_generation = UINT64_MAX;
+            return;
+        } // if
+
+        for (size_t i = self->words; i < words; ++i)
+        {
+            bits[i] = 0;
+        } // for
+        self->bits = bits;
+        self->words = words;
+    } // if
+
+    self->bits[word] |= (uint64_t) 1 << (key % 64);
+} // bitset_add
 
 
 int
@@ -29,7 +118,8 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 {
     assert(NULL != self);
 
-    if (UINT32_MAX == self->next || self->capacity < self->next)
+    if (UINT32_MAX == self->next ||
+        (self->capacity < self->next && 0 != grow(self)))
     {
         return -1;
     } // if
@@ -45,6 +135,14 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 
     insert(self, ptr);
 
+    // the nodes of a bulk load are not found until they are merged
+    if (NULLPTR != self->run)
+    {
+        self->bitset_generation = UINT64_MAX;
+        return 0;
+    } // if
+    bitset_add(self, key);
+
     return 0;
 } // vrd_AVL_tree_insert
 
@@ -55,18 +153,76 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_is_element)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) c
 {
     assert(NULL != self);
 
+    if (NULL != self->bits && self->bitset_generation == self->base.generation)
+    {
+        return (key / 64 < self->words && (self->bits[key / 64] >> (key % 64)) & 1) != self->complement;
+    } // if
+
+    if (NULL != self->frozen)
+    {
+        size_t const i = frozen_lower_bound(self, key);
+        return (i < self->base.entries && key == self->frozen[i].key) != self->complement;
+    } // if
+
     uint32_t tmp = self->root;
     while (NULLPTR != tmp)
     {
         if (key == self->nodes[tmp].key)
         {
-            return true;
+            return !self->complement;
         } // if
         tmp = self->nodes[tmp].child[key > self->nodes[tmp].key];
     } // while
 
-    return false;
+    return self->complement;
 } // vrd_AVL_tree_is_element
 
 
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_complement)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self)
+{
+    assert(NULL != self);
+
+    self->complement = !self->complement;
+} // vrd_AVL_tree_complement
+
+
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _tree_keys)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                       size_t const len,
+                                       size_t keys[len])
+{
+    assert(NULL != self);
+
+    if (NULL != self->frozen)
+    {
+        size_t const count = umin(len, self->base.entries);
+        for (size_t i = 0; i < count; ++i)
+        {
+            keys[i] = self->frozen[i].key;
+        } // for
+        return count;
+    } // if
+
+    uint32_t stack[VRD_STACK_SIZE];
+    size_t top = 0;
+
+    size_t count = 0;
+    uint32_t ptr = self->root;
+    while (count < len && (NULLPTR != ptr || 0 < top))
+    {
+        for (; NULLPTR != ptr; ptr = self->nodes[ptr].child[LEFT])
+        {
+            stack[top] = ptr;
+            top += 1;
+        } // for
+        top -= 1;
+        keys[count] = self->nodes[stack[top]].key;
+        count += 1;
+        ptr = self->nodes[stack[top]].child[RIGHT];
+    } // while
+    return count;
+} // vrd_AVL_tree_keys
+
+
 #undef VRD_TYPENAME
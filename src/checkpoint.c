@@ -0,0 +1,798 @@
+#define _POSIX_C_SOURCE 200809L     // clock_gettime, fileno, fstat,
+                                    // fsync, ftruncate
+
+
+#include <assert.h>     // assert
+#include <errno.h>      // ENOENT, errno
+#include <pthread.h>    // pthread_mutex_*
+#include <stdbool.h>    // bool
+#include <stddef.h>     // NULL, size_t
+#include <stdint.h>     // uint32_t, uint64_t
+#include <stdio.h>      // FILE, FILENAME_MAX, SEEK_*, fclose, fflush,
+                        // fopen, fread, fseek, ftell, fwrite, remove,
+                        // rename, snprintf
+#include <stdlib.h>     // free, malloc, realloc
+#include <string.h>     // memcmp, memcpy, memset
+#include <sys/mman.h>   // MAP_*, PROT_*, mmap
+#include <sys/stat.h>   // fstat, struct stat
+#include <time.h>       // CLOCK_REALTIME, clock_gettime
+#include <unistd.h>     // _SC_PAGESIZE, fsync, ftruncate, getpid, sysconf
+
+#include "../include/checkpoint.h"  // vrd_Checkpoint, vrd_checkpoint_*
+
+
+static char const MAGIC[8] = "VRDCKPT";
+static uint32_t const VERSION = 8;
+
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t alignment;
+    uint64_t serial;
+    uint64_t count;
+    uint64_t directory;
+    uint64_t live;  // the bytes in use by the header, the current sections
+                    // and the directory
+}; // Header
+
+
+struct Section
+{
+    char table[4];
+    uint32_t id;
+    uint32_t encoding;
+    uint32_t unused;
+    uint64_t offset;
+    uint64_t size;
+}; // Section
+
+
+struct vrd_Checkpoint
+{
+    FILE* stream;
+    unsigned int flags;
+
+    char path[FILENAME_MAX];
+    char tmp_path[FILENAME_MAX];    // written to before committing
+
+    size_t alignment;
+    size_t cursor;  // where to start looking for the next section
+
+    uint64_t serial;
+    uint64_t previous;  // the serial of the amended checkpoint
+    long end;   // the end of the amended checkpoint
+    uint64_t live;  // the bytes in use by the amended checkpoint
+
+    size_t threads;
+    pthread_mutex_t lock;   // for concurrent readers and writers
+    size_t tail;    // the end of the written and reserved sections
+
+    size_t capacity;
+    size_t count;
+    size_t current; // the section being written
+    struct Section* sections;
+}; // vrd_Checkpoint
+
+
+static void
+set_name(char name[4], char const* const table)
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        name[i] = table[i];
+        if ('\0' == table[i])
+        {
+            break;
+        } // if
+    } // for
+} // set_name
+
+
+static inline size_t
+align(vrd_Checkpoint const* const self, size_t const offset)
+{
+    return (offset + self->alignment - 1) / self->alignment * self->alignment;
+} // align
+
+
+// The header and the directory come from the file: the directory and
+// every section must lie within the file, such that nothing is
+// allocated or mapped past its end
+static int
+read_directory(vrd_Checkpoint* const self)
+{
+    struct stat info;
+    if (0 != fstat(fileno(self->stream), &info))
+    {
+        return errno;
+    } // if
+    uint64_t const file_size = info.st_size;
+
+    struct Header header;
+    if (1 != fread(&header, sizeof(header), 1, self->stream))
+    {
+        return -1;
+    } // if
+
+    if (0 != memcmp(header.magic, MAGIC, sizeof(MAGIC)) || VERSION != header.version ||
+        0 == header.alignment ||
+        sizeof(header) > header.directory || file_size < header.directory ||
+        (file_size - header.directory) / sizeof(self->sections[0]) < header.count)
+    {
+        return -1;
+    } // if
+
+    self->sections = malloc(sizeof(self->sections[0]) * header.count);
+    if (NULL == self->sections && 0 < header.count)
+    {
+        return errno;
+    } // if
+
+    self->alignment = header.alignment;
+    self->serial = header.serial;
+    self->live = header.live;
+    self->capacity = header.count;
+    self->count = header.count;
+
+    if (0 != fseek(self->stream, header.directory, SEEK_SET))
+    {
+        return errno;
+    } // if
+
+    if (self->count != fread(self->sections, sizeof(self->sections[0]), self->count, self->stream))
+    {
+        return -1;
+    } // if
+
+    for (size_t i = 0; i < self->count; ++i)
+    {
+        if (file_size < self->sections[i].offset ||
+            file_size - self->sections[i].offset < self->sections[i].size)
+        {
+            return -1;
+        } // if
+    } // for
+
+    return 0;
+} // read_directory
+
+
+static int
+write_directory(vrd_Checkpoint* const self)
+{
+    if (0 != fseek(self->stream, 0, SEEK_END))
+    {
+        return errno;
+    } // if
+
+    long directory = ftell(self->stream);
+    if (0 > directory)
+    {
+        return errno;
+    } // if
+
+    // reserved sections are written by now, but not necessarily in order
+    if ((size_t) directory < self->tail)
+    {
+        directory = self->tail;
+        if (0 != fseek(self->stream, directory, SEEK_SET))
+        {
+            return errno;
+        } // if
+    } // if
+
+    if (self->count != fwrite(self->sections, sizeof(self->sections[0]), self->count, self->stream))
+    {
+        return errno;
+    } // if
+
+    // sections are padded up to the start of the next one
+    uint64_t live = align(self, sizeof(struct Header)) + sizeof(self->sections[0]) * self->count;
+    for (size_t i = 0; i < self->count; ++i)
+    {
+        live += align(self, self->sections[i].size);
+    } // for
+
+    // the sections (of any stream on the file) and the directory are
+    // durable before the header points to them
+    if (0 != fflush(self->stream) || 0 != fsync(fileno(self->stream)))
+    {
+        return errno;
+    } // if
+
+    struct Header header =
+    {
+        .version = VERSION,
+        .alignment = self->alignment,
+        .serial = self->serial,
+        .count = self->count,
+        .directory = directory,
+        .live = live,
+    };
+    (void) memcpy(header.magic, MAGIC, sizeof(MAGIC));
+
+    // the header is written last, it commits the checkpoint
+    if (0 != fseek(self->stream, 0, SEEK_SET) ||
+        1 != fwrite(&header, sizeof(header), 1, self->stream))
+    {
+        return errno;
+    } // if
+
+    if (0 != fflush(self->stream) || 0 != fsync(fileno(self->stream)))
+    {
+        return errno;
+    } // if
+
+    return 0;
+} // write_directory
+
+
+// Unique for all practical purposes: checkpoints written by the same
+// process differ in time
+static uint64_t
+new_serial(void)
+{
+    struct timespec now = {0};
+    (void) clock_gettime(CLOCK_REALTIME, &now);
+    return ((uint64_t) now.tv_sec * 1000000000 + now.tv_nsec) ^
+           ((uint64_t) getpid() << 44);
+} // new_serial
+
+
+// Sections are appended to an existing checkpoint, that stays valid
+// until its header is rewritten to point to the new directory
+static int
+amend(vrd_Checkpoint* const self)
+{
+    int const err = read_directory(self);
+    if (0 != err)
+    {
+        return err;
+    } // if
+
+    if (0 != fseek(self->stream, 0, SEEK_END))
+    {
+        return errno;
+    } // if
+
+    self->end = ftell(self->stream);
+    if (0 > self->end)
+    {
+        return errno;
+    } // if
+
+    self->previous = self->serial;
+    self->serial += 1;
+    self->tail = self->end;
+
+    return 0;
+} // amend
+
+
+vrd_Checkpoint*
+vrd_checkpoint_open(char const* const path, unsigned int const flags)
+{
+    assert(NULL != path);
+
+    vrd_Checkpoint* const self = malloc(sizeof(*self));
+    if (NULL == self)
+    {
+        return NULL;
+    } // if
+
+    if (0 >= snprintf(self->path, sizeof(self->path), "%s", path) ||
+        0 >= snprintf(self->tmp_path, sizeof(self->tmp_path), "%s.tmp", path))
+    {
+        free(self);
+        return NULL;
+    } // if
+
+    int const err = pthread_mutex_init(&self->lock, NULL);
+    if (0 != err)
+    {
+        free(self);
+        errno = err;
+        return NULL;
+    } // if
+
+    self->flags = flags;
+    self->alignment = sysconf(_SC_PAGESIZE);
+    self->cursor = 0;
+    self->serial = 0;
+    self->previous = 0;
+    self->end = 0;
+    self->live = 0;
+    self->threads = 1;
+    self->tail = 0;
+    self->capacity = 0;
+    self->count = 0;
+    self->current = 0;
+    self->sections = NULL;
+
+    if ((flags & VRD_CHECKPOINT_WRITE) && (flags & VRD_CHECKPOINT_INCREMENTAL))
+    {
+        self->stream = fopen(path, "r+b");
+        if (NULL != self->stream)
+        {
+            int const ret = amend(self);
+            if (0 != ret)
+            {
+                (void) fclose(self->stream);
+                (void) pthread_mutex_destroy(&self->lock);
+                free(self->sections);
+                free(self);
+                errno = ret;
+                return NULL;
+            } // if
+
+            if ((uint64_t) self->end <= 2 * self->live)
+            {
+                return self;
+            } // if
+
+            // most of the file is superseded sections: it is rewritten
+            // from scratch instead of growing without bound
+            (void) fclose(self->stream);
+            free(self->sections);
+            self->alignment = sysconf(_SC_PAGESIZE);
+            self->cursor = 0;
+            self->previous = 0;
+            self->end = 0;
+            self->live = 0;
+            self->capacity = 0;
+            self->count = 0;
+            self->sections = NULL;
+        } // if
+        else if (ENOENT != errno)
+        {
+            (void) pthread_mutex_destroy(&self->lock);
+            free(self);
+            return NULL;
+        } // if
+
+        // there is nothing (worth) to amend
+        self->flags &= ~VRD_CHECKPOINT_INCREMENTAL;
+    } // if
+
+    if (flags & VRD_CHECKPOINT_WRITE)
+    {
+        self->serial = new_serial();
+
+        self->stream = fopen(self->tmp_path, "wb");
+        if (NULL == self->stream)
+        {
+            (void) pthread_mutex_destroy(&self->lock);
+            free(self);
+            return NULL;
+        } // if
+
+        // reserve room for the header
+        struct Header const header = {.version = 0};
+        if (1 != fwrite(&header, sizeof(header), 1, self->stream))
+        {
+            (void) fclose(self->stream);
+            (void) remove(self->tmp_path);
+            (void) pthread_mutex_destroy(&self->lock);
+            free(self);
+            return NULL;
+        } // if
+
+        self->tail = sizeof(header);
+        return self;
+    } // if
+
+    self->stream = fopen(path, "rb");
+    if (NULL == self->stream)
+    {
+        (void) pthread_mutex_destroy(&self->lock);
+        free(self);
+        return NULL;
+    } // if
+
+    int const ret = read_directory(self);
+    if (0 != ret)
+    {
+        (void) fclose(self->stream);
+        (void) pthread_mutex_destroy(&self->lock);
+        free(self->sections);
+        free(self);
+        errno = ret;
+        return NULL;
+    } // if
+
+    return self;
+} // vrd_checkpoint_open
+
+
+int
+vrd_checkpoint_close(vrd_Checkpoint** const self)
+{
+    if (NULL == self || NULL == *self)
+    {
+        return 0;
+    } // if
+
+    bool const amended = (*self)->flags & VRD_CHECKPOINT_INCREMENTAL;
+
+    int err = 0;
+    if ((*self)->flags & VRD_CHECKPOINT_WRITE)
+    {
+        err = write_directory(*self);
+    } // if
+
+    if (0 != fclose((*self)->stream) && 0 == err)
+    {
+        err = errno;
+    } // if
+
+    if (((*self)->flags & VRD_CHECKPOINT_WRITE) && !amended)
+    {
+        if (0 == err && 0 != rename((*self)->tmp_path, (*self)->path))
+        {
+            err = errno;
+        } // if
+        if (0 != err)
+        {
+            (void) remove((*self)->tmp_path);
+        } // if
+    } // if
+
+    (void) pthread_mutex_destroy(&(*self)->lock);
+    free((*self)->sections);
+    free(*self);
+    *self = NULL;
+
+    return err;
+} // vrd_checkpoint_close
+
+
+void
+vrd_checkpoint_abort(vrd_Checkpoint** const self)
+{
+    if (NULL == self || NULL == *self)
+    {
+        return;
+    } // if
+
+    if ((*self)->flags & VRD_CHECKPOINT_INCREMENTAL)
+    {
+        // drop the appended sections, the header is untouched
+        (void) fflush((*self)->stream);
+        (void) ftruncate(fileno((*self)->stream), (*self)->end);
+        (void) fclose((*self)->stream);
+    } // if
+    else
+    {
+        (void) fclose((*self)->stream);
+        if ((*self)->flags & VRD_CHECKPOINT_WRITE)
+        {
+            (void) remove((*self)->tmp_path);
+        } // if
+    } // else
+
+    (void) pthread_mutex_destroy(&(*self)->lock);
+    free((*self)->sections);
+    free(*self);
+    *self = NULL;
+} // vrd_checkpoint_abort
+
+
+unsigned int
+vrd_checkpoint_flags(vrd_Checkpoint const* const self)
+{
+    assert(NULL != self);
+
+    return self->flags;
+} // vrd_checkpoint_flags
+
+
+uint64_t
+vrd_checkpoint_serial(vrd_Checkpoint const* const self)
+{
+    assert(NULL != self);
+
+    return self->serial;
+} // vrd_checkpoint_serial
+
+
+uint64_t
+vrd_checkpoint_previous(vrd_Checkpoint const* const self)
+{
+    assert(NULL != self);
+
+    return self->previous;
+} // vrd_checkpoint_previous
+
+
+void
+vrd_checkpoint_set_threads(vrd_Checkpoint* const self, size_t const threads)
+{
+    assert(NULL != self);
+
+    self->threads = 0 < threads ? threads : 1;
+} // vrd_checkpoint_set_threads
+
+
+size_t
+vrd_checkpoint_threads(vrd_Checkpoint const* const self)
+{
+    assert(NULL != self);
+
+    return self->threads;
+} // vrd_checkpoint_threads
+
+
+FILE*
+vrd_checkpoint_stream(vrd_Checkpoint* const self)
+{
+    assert(NULL != self);
+
+    if (!(self->flags & VRD_CHECKPOINT_WRITE))
+    {
+        return fopen(self->path, "rb");
+    } // if
+
+    // the sections written so far must be visible to the new stream
+    if (0 != fflush(self->stream))
+    {
+        return NULL;
+    } // if
+
+    return fopen(self->flags & VRD_CHECKPOINT_INCREMENTAL ? self->path : self->tmp_path, "r+b");
+} // vrd_checkpoint_stream
+
+
+static struct Section const*
+find(vrd_Checkpoint* const self,
+     char const* const table,
+     uint32_t const id)
+{
+    char name[4] = {'\0'};
+    set_name(name, table);
+
+    // tables store their sections in order
+    for (size_t i = 0; i < self->count; ++i)
+    {
+        size_t const idx = (self->cursor + i) % self->count;
+        if (id == self->sections[idx].id &&
+            0 == memcmp(name, self->sections[idx].table, sizeof(name)))
+        {
+            self->cursor = idx + 1;
+            return &self->sections[idx];
+        } // if
+    } // for
+
+    return NULL;
+} // find
+
+
+// Returns the index of a new directory entry for a section, or `count`
+// if the directory cannot grow
+static size_t
+new_section(vrd_Checkpoint* const self,
+            char const* const table,
+            uint32_t const id,
+            uint32_t const encoding,
+            size_t const offset,
+            size_t const size)
+{
+    if (self->count >= self->capacity)
+    {
+        size_t const capacity = 0 < self->capacity ? self->capacity * 2 : 64;
+        struct Section* const sections = realloc(self->sections, sizeof(sections[0]) * capacity);
+        if (NULL == sections)
+        {
+            return self->capacity;
+        } // if
+        self->sections = sections;
+        self->capacity = capacity;
+    } // if
+
+    // an amended section replaces its previous version
+    size_t idx = self->count;
+    if (self->flags & VRD_CHECKPOINT_INCREMENTAL)
+    {
+        struct Section const* const previous = find(self, table, id);
+        if (NULL != previous)
+        {
+            idx = previous - self->sections;
+        } // if
+    } // if
+
+    struct Section* const section = &self->sections[idx];
+    (void) memset(section->table, '\0', sizeof(section->table));
+    set_name(section->table, table);
+    section->id = id;
+    section->encoding = encoding;
+    section->unused = 0;
+    section->offset = offset;
+    section->size = size;
+
+    return idx;
+} // new_section
+
+
+FILE*
+vrd_checkpoint_begin(vrd_Checkpoint* const self,
+                     char const* const table,
+                     uint32_t const id,
+                     uint32_t const encoding)
+{
+    assert(NULL != self);
+    assert(NULL != table);
+    assert(self->flags & VRD_CHECKPOINT_WRITE);
+
+    // skipping the padding leaves a hole in the file
+    size_t const offset = align(self, self->tail);
+    if (0 != fseek(self->stream, offset, SEEK_SET))
+    {
+        return NULL;
+    } // if
+
+    self->current = new_section(self, table, id, encoding, offset, 0);
+    if (self->capacity == self->current)
+    {
+        return NULL;
+    } // if
+
+    return self->stream;
+} // vrd_checkpoint_begin
+
+
+int
+vrd_checkpoint_end(vrd_Checkpoint* const self)
+{
+    assert(NULL != self);
+    assert(self->flags & VRD_CHECKPOINT_WRITE);
+
+    long const end = ftell(self->stream);
+    if (0 > end)
+    {
+        return errno;
+    } // if
+
+    self->sections[self->current].size = end - self->sections[self->current].offset;
+    if (self->current == self->count)
+    {
+        self->count += 1;
+    } // if
+    self->tail = end;
+
+    return 0;
+} // vrd_checkpoint_end
+
+
+long
+vrd_checkpoint_reserve(vrd_Checkpoint* const self,
+                       char const* const table,
+                       uint32_t const id,
+                       uint32_t const encoding,
+                       size_t const size)
+{
+    assert(NULL != self);
+    assert(NULL != table);
+    assert(self->flags & VRD_CHECKPOINT_WRITE);
+
+    (void) pthread_mutex_lock(&self->lock);
+
+    size_t const offset = align(self, self->tail);
+    size_t const idx = new_section(self, table, id, encoding, offset, size);
+    if (self->capacity == idx)
+    {
+        (void) pthread_mutex_unlock(&self->lock);
+        return -1;
+    } // if
+
+    if (idx == self->count)
+    {
+        self->count += 1;
+    } // if
+    self->tail = offset + size;
+
+    (void) pthread_mutex_unlock(&self->lock);
+
+    return offset;
+} // vrd_checkpoint_reserve
+
+
+// A copy of a section, safe for concurrent readers
+static bool
+locate(vrd_Checkpoint* const self,
+       char const* const table,
+       uint32_t const id,
+       struct Section* const section)
+{
+    (void) pthread_mutex_lock(&self->lock);
+    struct Section const* const found = find(self, table, id);
+    if (NULL != found)
+    {
+        *section = *found;
+    } // if
+    (void) pthread_mutex_unlock(&self->lock);
+
+    return NULL != found;
+} // locate
+
+
+int
+vrd_checkpoint_seek(vrd_Checkpoint* const self,
+                    FILE* const stream,
+                    char const* const table,
+                    uint32_t const id,
+                    size_t* const size,
+                    uint32_t* const encoding)
+{
+    assert(NULL != self);
+    assert(NULL != stream);
+    assert(NULL != table);
+    assert(NULL != size);
+
+    struct Section section;
+    if (!locate(self, table, id, &section))
+    {
+        return -1;
+    } // if
+
+    if (0 != fseek(stream, section.offset, SEEK_SET))
+    {
+        return errno;
+    } // if
+
+    *size = section.size;
+    if (NULL != encoding)
+    {
+        *encoding = section.encoding;
+    } // if
+    return 0;
+} // vrd_checkpoint_seek
+
+
+FILE*
+vrd_checkpoint_find(vrd_Checkpoint* const self,
+                    char const* const table,
+                    uint32_t const id,
+                    size_t* const size,
+                    uint32_t* const encoding)
+{
+    int const err = vrd_checkpoint_seek(self, self->stream, table, id, size, encoding);
+    if (0 != err)
+    {
+        errno = err;
+        return NULL;
+    } // if
+
+    return self->stream;
+} // vrd_checkpoint_find
+
+
+void*
+vrd_checkpoint_map(vrd_Checkpoint* const self,
+                   char const* const table,
+                   uint32_t const id,
+                   size_t* const size)
+{
+    assert(NULL != self);
+    assert(NULL != table);
+    assert(NULL != size);
+
+    struct Section section;
+    if (!locate(self, table, id, &section) || 0 == section.size ||
+        VRD_ENCODING_RAW != section.encoding ||
+        0 != section.offset % sysconf(_SC_PAGESIZE))
+    {
+        return NULL;
+    } // if
+
+    // A private writable mapping shares the page cache between processes
+    // and keeps the file untouched by in-place updates (remove, reorder)
+    void* const addr = mmap(NULL, section.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(self->stream), section.offset);
+    if (MAP_FAILED == addr)
+    {
+        return NULL;
+    } // if
+
+    *size = section.size;
+    return addr;
+} // vrd_checkpoint_map
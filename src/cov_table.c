@@ -54,6 +54,60 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query_stab)(VRD_TEMPLATE(VRD_TYPENAME, _Table)
 } // vrd_Cov_table_query_stab
 
 
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_stab_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                    size_t const len,
+                                                    char const reference[len],
+                                                    size_t const n,
+                                                    size_t const start[n],
+                                                    size_t const end[n],
+                                                    vrd_AVL_Tree const* const subset,
+                                                    size_t result[n])
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = -1;
+        } // for
+        return -1;
+    } // if
+
+    VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab_batch)(elem->data, n, start, end, subset, result);
+    return 0;
+} // vrd_Cov_table_query_stab_batch
+
+
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_stab_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                     size_t const len,
+                                                     char const reference[len],
+                                                     size_t const n,
+                                                     size_t const start[n],
+                                                     size_t const end[n],
+                                                     vrd_AVL_Tree const* const subset,
+                                                     size_t result[n])
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = -1;
+        } // for
+        return -1;
+    } // if
+
+    VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab_sorted)(elem->data, n, start, end, subset, result);
+    return 0;
+} // vrd_Cov_table_query_stab_sorted
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                                 size_t const len_ref,
@@ -1,11 +1,18 @@
 #include <assert.h>     // assert
+#include <errno.h>      // errno
+#include <stdbool.h>    // bool
 #include <stddef.h>     // NULL, size_t
 #include <stdint.h>     // int32_t, uint32_t
+#include <stdlib.h>     // free, realloc
+#include <string.h>     // memcpy
 
 #include "../include/avl_tree.h"    // vrd_AVL_Tree
+#include "../include/constants.h"   // VRD_MAX_POSITION
 #include "../include/template.h"    // VRD_TEMPLATE
 #include "cov_tree.h"   // vrd_Cov_Tree, vrd_Cov_tree_*
-#include "tree.h"       // NULLPTR, LEFT, RIGHT
+#include "depth_tree.h" // vrd_Depth_tree_depth, vrd_Depth_tree_depth_batch
+#include "imath.h"      // umax
+#include "tree.h"       // NULLPTR, LEFT, RIGHT, VRD_*_SIZE
 
 
 #define VRD_TYPENAME Cov
@@ -13,8 +20,6 @@
 
 struct VRD_TEMPLATE(VRD_TYPENAME, _Node)
 {
-    uint32_t child[2];
-
     uint32_t key       : 28;    // start
     uint32_t count     :  4;
 
@@ -23,12 +28,76 @@ struct VRD_TEMPLATE(VRD_TYPENAME, _Node)
 
     int32_t  balance   :  3;    // [-4, ..., 3], we use [-2, ..., 2]
     uint32_t sample_id : 29;
+
+    uint32_t child[2];
 }; // vrd_Cov_Node
 
 
+// A node of a frozen tree (see: vrd_Cov_tree_freeze): a node without its
+// child pointers. The layouts agree up to there, such that query results
+// of either tree can be unpacked alike.
+struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)
+{
+    uint32_t key       : 28;    // start
+    uint32_t count     :  4;
+
+    uint32_t end;
+    uint32_t max;      // unused, the index holds the largest ends
+
+    int32_t  balance   :  3;    // unused
+    uint32_t sample_id : 29;
+}; // vrd_Cov_Frozen
+
+
+static inline void
+node_freeze(struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)* const frozen,
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node)
+{
+    frozen->key = node->key;
+    frozen->count = node->count;
+    frozen->end = node->end;
+    frozen->max = node->end;
+    frozen->balance = 0;
+    frozen->sample_id = node->sample_id;
+} // node_freeze
+
+
+// the fields of a packed node: key, length, count, sample_id
+#define VRD_FIELDS 4
+
+
+static inline void
+node_pack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node,
+          uint32_t field[VRD_FIELDS])
+{
+    field[0] = node->key;
+    field[1] = node->end - node->key;
+    field[2] = node->count;
+    field[3] = node->sample_id;
+} // node_pack
+
+
+static inline void
+node_unpack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node)* const node,
+            uint32_t const field[VRD_FIELDS])
+{
+    node->key = field[0];
+    node->end = field[0] + field[1];
+    node->count = field[2];
+    node->sample_id = field[3];
+} // node_unpack
+
+
+// The trees keep the depth along the reference for stabs at a single
+// position without a subset (see: depth_tree.h)
+#define VRD_DEPTH
+
+
 #define VRD_INTERVAL
 #include "template_tree.inc"    // vrd_Cov_tree_*
 #undef VRD_INTERVAL
+#undef VRD_DEPTH
+#undef VRD_FIELDS
 
 
 void
@@ -38,11 +107,13 @@ VRD_TEMPLATE(VRD_TYPENAME, _unpack)(void* const ptr,
                                     size_t* const count,
                                     size_t* const sample_id)
 {
-    struct vrd_Cov_Node const* const node = ptr;
-    *start = node->key;
-    *end = node->end;
-    *count = node->count;
-    *sample_id = node->sample_id;
+    // a node or a frozen node
+    struct vrd_Cov_Frozen node;
+    memcpy(&node, ptr, sizeof(node));
+    *start = node.key;
+    *end = node.end;
+    *count = node.count;
+    *sample_id = node.sample_id;
 } // vrd_Cov_unpack
 
 
@@ -55,7 +126,8 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 {
     assert(NULL != self);
 
-    if (UINT32_MAX == self->next || self->capacity < self->next)
+    if (UINT32_MAX == self->next ||
+        (self->capacity < self->next && 0 != grow(self)))
     {
         return -1;
     } // if
@@ -80,64 +152,150 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 
 static size_t
 query_stab(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
-           size_t const root,
+           uint32_t const root,
            size_t const start,
            size_t const end,
            vrd_AVL_Tree const* const subset)
 {
-    if (NULLPTR == root || self->nodes[root].max < start)
-    {
-        return 0;
-    } // if
-
-    if (self->nodes[root].key > start)
-    {
-        return query_stab(self, self->nodes[root].child[LEFT], start, end, subset);
-    } // if
+    uint32_t stack[VRD_STACK_SIZE] = {root};
+    size_t top = NULLPTR != root;
 
     size_t res = 0;
-    if (start >= self->nodes[root].key && end <= self->nodes[root].end &&
-        (NULL == subset || vrd_AVL_tree_is_element(subset, self->nodes[root].sample_id)))
+    while (0 < top)
     {
-        res = self->nodes[root].count;
-    } // if
-
-    return res + query_stab(self, self->nodes[root].child[LEFT], start, end, subset) +
-                 query_stab(self, self->nodes[root].child[RIGHT], start, end, subset);
+        top -= 1;
+        uint32_t ptr = stack[top];
+        // subtrees that end before `start` are skipped
+        while (NULLPTR != ptr && self->nodes[ptr].max >= start)
+        {
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[ptr];
+            if (node->key <= start)
+            {
+                if (end <= node->end && selected(self, subset, node->sample_id))
+                {
+                    res += node->count;
+                } // if
+
+                if (NULLPTR != node->child[RIGHT])
+                {
+                    stack[top] = node->child[RIGHT];
+                    top += 1;
+                } // if
+            } // if
+            ptr = node->child[LEFT];
+        } // while
+    } // while
+    return res;
 } // query_stab
 
 
+// Collects the nodes in the region in pre-order
 static size_t
 query_region(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
-             size_t const root,
+             uint32_t const root,
              size_t const start,
              size_t const end,
              vrd_AVL_Tree const* const subset,
-             size_t const next,
              size_t const len,
              void* result[len])
 {
-    if (NULLPTR == root || self->nodes[root].max < start)
+    uint32_t stack[VRD_STACK_SIZE] = {root};
+    size_t top = NULLPTR != root;
+
+    size_t next = 0;
+    while (0 < top && next < len)
     {
-        return 0;
-    } // if
+        top -= 1;
+        uint32_t ptr = stack[top];
+        while (NULLPTR != ptr && next < len && self->nodes[ptr].max >= start)
+        {
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[ptr];
+            if (node->key <= end)
+            {
+                if (start <= node->key && end > node->end &&
+                    selected(self, subset, node->sample_id))
+                {
+                    result[next] = (void*) node;
+                    next += 1;
+                } // if
+
+                if (NULLPTR != node->child[RIGHT])
+                {
+                    stack[top] = node->child[RIGHT];
+                    top += 1;
+                } // if
+            } // if
+            ptr = node->child[LEFT];
+        } // while
+    } // while
+    return next;
+} // query_region
+
 
-    if (self->nodes[root].key > end)
+// Visits the children of a node of the index that start before `start`
+// and may end after `end`, the blocks of leaves are scanned sequentially
+static size_t
+query_stab_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                  size_t const level,
+                  size_t const node,
+                  size_t const start,
+                  size_t const end,
+                  vrd_AVL_Tree const* const subset)
+{
+    size_t res = 0;
+    if (0 == level)
     {
-        return query_region(self, self->nodes[root].child[LEFT], start, end, subset, next, len, result);
+        for (size_t i = node * FANOUT;
+             i < frozen_block_end(self, node) && self->frozen[i].key <= start;
+             ++i)
+        {
+            if (end <= self->frozen[i].end &&
+                selected(self, subset, self->frozen[i].sample_id))
+            {
+                res += self->frozen[i].count;
+            } // if
+        } // for
+        return res;
     } // if
 
-    size_t match = 0;
-    if (start <= self->nodes[root].key && end > self->nodes[root].end &&
-        (NULL == subset || vrd_AVL_tree_is_element(subset, self->nodes[root].sample_id)))
+    uint32_t const* const keys = frozen_node(self, level, node);
+    uint32_t const* const max = &keys[FANOUT];
+    for (size_t i = 0;
+         i < FANOUT && node * FANOUT + i < self->size[level - 1] && keys[i] <= start;
+         ++i)
     {
-        result[next] = (void*) &self->nodes[root];
-        match = 1;
-    } // if
+        if (end <= max[i])
+        {
+            res += query_stab_frozen(self, level - 1, node * FANOUT + i, start, end, subset);
+        } // if
+    } // for
+    return res;
+} // query_stab_frozen
 
-    size_t const count = query_region(self, self->nodes[root].child[LEFT], start, end, subset, next + match, len, result);
-    return query_region(self, self->nodes[root].child[RIGHT], start, end, subset, count, len, result);
-} // query_region
+
+// The regions contained in [start, end) start in it: a sequential scan
+static size_t
+query_region_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                    size_t const start,
+                    size_t const end,
+                    vrd_AVL_Tree const* const subset,
+                    size_t const len,
+                    void* result[len])
+{
+    size_t next = 0;
+    for (size_t i = frozen_lower_bound(self, start);
+         i < self->base.entries && next < len && self->frozen[i].key <= end;
+         ++i)
+    {
+        if (end > self->frozen[i].end &&
+            selected(self, subset, self->frozen[i].sample_id))
+        {
+            result[next] = (void*) &self->frozen[i];
+            next += 1;
+        } // if
+    } // for
+    return next;
+} // query_region_frozen
 
 
 size_t
@@ -148,10 +306,287 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) c
 {
     assert(NULL != self);
 
+    // the annotation of a single position in the whole database
+    if (NULL == subset && NULL == self->retracted && start + 1 == end &&
+        NULL != self->depth && sums_exact(self))
+    {
+        return vrd_Depth_tree_depth(self->depth, start);
+    } // if
+
+    VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const tree = current(self);
+    if (NULL != tree->frozen)
+    {
+        return query_stab_frozen(tree, tree->levels, 0, start, end, subset);
+    } // if
+
     return query_stab(self, self->root, start, end, subset);
 } // vrd_Cov_tree_query_stab
 
 
+// Answers the point lookups `index` of a batch from the depth
+static void
+depth_batch(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+            size_t const count,
+            size_t const index[count],
+            size_t const position[count],
+            size_t result[])
+{
+    size_t depth[VRD_BATCH_SIZE];
+    vrd_Depth_tree_depth_batch(self->depth, count, position, depth);
+    for (size_t i = 0; i < count; ++i)
+    {
+        result[index[i]] = depth[i];
+    } // for
+} // depth_batch
+
+
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                                   size_t const n,
+                                                   size_t const start[n],
+                                                   size_t const end[n],
+                                                   vrd_AVL_Tree const* const subset,
+                                                   size_t result[n])
+{
+    assert(NULL != self);
+
+    // only the depths of single positions are descents that interleave
+    bool const points = NULL == subset && NULL == self->retracted && NULL != self->depth &&
+                        sums_exact(self);
+
+    size_t index[VRD_BATCH_SIZE];
+    size_t position[VRD_BATCH_SIZE];
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!points || start[i] + 1 != end[i])
+        {
+            result[i] = VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab)(self, start[i], end[i], subset);
+            continue;
+        } // if
+
+        index[count] = i;
+        position[count] = start[i];
+        count += 1;
+        if (VRD_BATCH_SIZE == count)
+        {
+            depth_batch(self, count, index, position, result);
+            count = 0;
+        } // if
+    } // for
+
+    if (0 < count)
+    {
+        depth_batch(self, count, index, position, result);
+    } // if
+} // vrd_Cov_tree_query_stab_batch
+
+
+// The regions that contain the position of a sorted stab query, in no
+// particular order, and a cursor at the first region after it
+struct Sweep
+{
+    size_t position;
+    size_t count;
+    size_t capacity;
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)* regions;
+    struct Cursor cursor;
+}; // Sweep
+
+
+// The number of regions a sweep passes before it rather collects the
+// regions at a position anew: the probes are far apart
+static size_t const SWEEP_SKIP = 64;
+
+
+static int
+sweep_add(struct Sweep* const sweep,
+          struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) const* const region)
+{
+    if (sweep->capacity <= sweep->count)
+    {
+        size_t const capacity = umax(16, sweep->capacity * 2);
+        struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)* const regions =
+            realloc(sweep->regions, sizeof(regions[0]) * capacity);
+        if (NULL == regions)
+        {
+            return errno;
+        } // if
+
+        sweep->regions = regions;
+        sweep->capacity = capacity;
+    } // if
+
+    sweep->regions[sweep->count] = *region;
+    sweep->count += 1;
+    return 0;
+} // sweep_add
+
+
+// Collects the regions that contain a position (see: query_stab) and
+// moves the cursor past the regions that start up to it
+static int
+sweep_restart(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+              struct Sweep* const sweep,
+              size_t const position)
+{
+    sweep->position = position;
+    sweep->count = 0;
+
+    uint32_t stack[VRD_STACK_SIZE] = {self->root};
+    size_t top = NULLPTR != self->root;
+    while (0 < top)
+    {
+        top -= 1;
+        uint32_t ptr = stack[top];
+        while (NULLPTR != ptr && self->nodes[ptr].max >= position)
+        {
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[ptr];
+            if (node->key <= position)
+            {
+                if (position <= node->end)
+                {
+                    struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) region;
+                    memcpy(&region, node, sizeof(region));
+                    int const err = sweep_add(sweep, &region);
+                    if (0 != err)
+                    {
+                        return err;
+                    } // if
+                } // if
+
+                if (NULLPTR != node->child[RIGHT])
+                {
+                    stack[top] = node->child[RIGHT];
+                    top += 1;
+                } // if
+            } // if
+            ptr = node->child[LEFT];
+        } // while
+    } // while
+
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) probe = {0};
+    probe.key = position;
+    cursor_init(&sweep->cursor, self);
+    cursor_seek(&sweep->cursor, &probe);
+
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) node;
+    while (cursor_peek(&sweep->cursor, &node) && node.key <= position)
+    {
+        cursor_next(&sweep->cursor);
+    } // while
+    return 0;
+} // sweep_restart
+
+
+// Moves a sweep forward to a position: the regions that end before it
+// are dropped, the regions that start up to it are added
+static int
+sweep_advance(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+              struct Sweep* const sweep,
+              size_t const position)
+{
+    size_t next = 0;
+    for (size_t i = 0; i < sweep->count; ++i)
+    {
+        if (position <= sweep->regions[i].end)
+        {
+            sweep->regions[next] = sweep->regions[i];
+            next += 1;
+        } // if
+    } // for
+    sweep->count = next;
+    sweep->position = position;
+
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) node;
+    for (size_t passed = 0;
+         cursor_peek(&sweep->cursor, &node) && node.key <= position;
+         ++passed)
+    {
+        if (SWEEP_SKIP < passed)
+        {
+            return sweep_restart(self, sweep, position);
+        } // if
+
+        if (position <= node.end)
+        {
+            int const err = sweep_add(sweep, &node);
+            if (0 != err)
+            {
+                return err;
+            } // if
+        } // if
+        cursor_next(&sweep->cursor);
+    } // for
+    return 0;
+} // sweep_advance
+
+
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                                    size_t const n,
+                                                    size_t const start[n],
+                                                    size_t const end[n],
+                                                    vrd_AVL_Tree const* const subset,
+                                                    size_t result[n])
+{
+    assert(NULL != self);
+
+    if (NULL != current(self)->frozen)
+    {
+        VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab_batch)(self, n, start, end, subset, result);
+        return;
+    } // if
+
+    // the depths of single positions in the whole database are cheaper
+    bool const points = NULL == subset && NULL == self->retracted && NULL != self->depth &&
+                        sums_exact(self);
+
+    struct Sweep sweep = {0, 0, 0, NULL, {0}};
+    bool valid = false;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if ((points && start[i] + 1 == end[i]) || start[i] >= end[i] ||
+            VRD_MAX_POSITION < start[i])
+        {
+            result[i] = VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab)(self, start[i], end[i], subset);
+            continue;
+        } // if
+
+        int err = 0;
+        if (!valid || start[i] < sweep.position)
+        {
+            err = sweep_restart(self, &sweep, start[i]);
+        } // if
+        else if (start[i] > sweep.position)
+        {
+            err = sweep_advance(self, &sweep, start[i]);
+        } // if
+
+        // without memory for the sweep the regions are answered one by one
+        valid = 0 == err;
+        if (!valid)
+        {
+            result[i] = VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab)(self, start[i], end[i], subset);
+            continue;
+        } // if
+
+        size_t res = 0;
+        for (size_t j = 0; j < sweep.count; ++j)
+        {
+            if (end[i] <= sweep.regions[j].end &&
+                selected(self, subset, sweep.regions[j].sample_id))
+            {
+                res += sweep.regions[j].count;
+            } // if
+        } // for
+        result[i] = res;
+    } // for
+
+    free(sweep.regions);
+} // vrd_Cov_tree_query_stab_sorted
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
                                                size_t const start,
@@ -162,7 +597,13 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)
 {
     assert(NULL != self);
 
-    return query_region(self, self->root, start, end, subset, 0, len, result);
+    VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const tree = current(self);
+    if (NULL != tree->frozen)
+    {
+        return query_region_frozen(tree, start, end, subset, len, result);
+    } // if
+
+    return query_region(self, self->root, start, end, subset, len, result);
 } // vrd_Cov_tree_query_region
 
 
@@ -34,6 +34,40 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) c
                                              vrd_AVL_Tree const* const subset);
 
 
+/**
+ * The allele counts of `n` regions, as with vrd_Cov_tree_query_stab().
+ * The depths of single positions in the whole database descend in
+ * lockstep to overlap their cache misses, other regions are answered
+ * one by one.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                                   size_t const n,
+                                                   size_t const start[n],
+                                                   size_t const end[n],
+                                                   vrd_AVL_Tree const* const subset,
+                                                   size_t result[n]);
+
+
+/**
+ * The allele counts of `n` regions, as with vrd_Cov_tree_query_stab(),
+ * for regions in order of their start: a sweep along the tree keeps the
+ * regions that contain the current start, each region of the tree is
+ * visited once. A region that starts before the previous one starts a
+ * new sweep, so unsorted regions are answered correctly, only slower.
+ * The depths of single positions in the whole database are looked up
+ * as with vrd_Cov_tree_query_stab_batch(), frozen trees are answered
+ * as a batch.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_stab_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                                    size_t const n,
+                                                    size_t const start[n],
+                                                    size_t const end[n],
+                                                    vrd_AVL_Tree const* const subset,
+                                                    size_t result[n]);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
                                                size_t const start,
@@ -0,0 +1,409 @@
+#include <assert.h>     // assert
+#include <errno.h>      // errno
+#include <stdbool.h>    // bool, false
+#include <stddef.h>     // NULL, size_t
+#include <stdint.h>     // UINT32_MAX, int32_t, uint32_t, uint64_t
+#include <stdlib.h>     // free, malloc, realloc
+
+#include "depth_tree.h" // vrd_Depth_Tree, vrd_Depth_tree_*
+#include "imath.h"      // umax
+#include "tree.h"       // NULLPTR, LEFT, RIGHT, VRD_BATCH_SIZE
+
+
+// The changes in depth are kept modulo 2^32: a depth (a sum of changes)
+// is exact as long as the allele count of all regions fits, which the
+// coverage tree checks before it asks for one
+struct Node
+{
+    uint32_t key;       // position
+    uint32_t delta;     // the change in depth at the position
+    uint32_t sum;       // the changes in depth of the subtree
+    int32_t  balance;
+
+    uint32_t child[2];
+}; // Node
+
+
+struct vrd_Depth_Tree
+{
+    uint32_t root;
+    uint32_t capacity;
+    uint32_t next;
+    struct Node* nodes;
+}; // vrd_Depth_Tree
+
+
+vrd_Depth_Tree*
+vrd_Depth_tree_init(size_t const capacity)
+{
+    if ((size_t) UINT32_MAX <= capacity)
+    {
+        errno = -1;
+        return NULL;
+    } // if
+
+    vrd_Depth_Tree* const tree = malloc(sizeof(*tree));
+    if (NULL == tree)
+    {
+        return NULL;
+    } // if
+
+    tree->nodes = malloc(sizeof(tree->nodes[0]) * (capacity + 1));
+    if (NULL == tree->nodes)
+    {
+        free(tree);
+        return NULL;
+    } // if
+
+    tree->root = NULLPTR;
+    tree->next = 1;  // we skip the 0th element as we use 0 as NULL pointer
+    tree->capacity = capacity;
+
+    return tree;
+} // vrd_Depth_tree_init
+
+
+void
+vrd_Depth_tree_destroy(vrd_Depth_Tree** const self)
+{
+    if (NULL == self || NULL == *self)
+    {
+        return;
+    } // if
+
+    free((*self)->nodes);
+    free(*self);
+    *self = NULL;
+} // vrd_Depth_tree_destroy
+
+
+void
+vrd_Depth_tree_clear(vrd_Depth_Tree* const self)
+{
+    assert(NULL != self);
+
+    self->root = NULLPTR;
+    self->next = 1;
+} // vrd_Depth_tree_clear
+
+
+static int
+grow(vrd_Depth_Tree* const self)
+{
+    size_t const capacity = umax(1, (size_t) self->capacity * 2);
+    if ((size_t) UINT32_MAX <= capacity)
+    {
+        return -1;
+    } // if
+
+    struct Node* const nodes = realloc(self->nodes, sizeof(nodes[0]) * (capacity + 1));
+    if (NULL == nodes)
+    {
+        return errno;
+    } // if
+
+    self->nodes = nodes;
+    self->capacity = capacity;
+
+    return 0;
+} // grow
+
+
+static inline uint32_t
+subtree_sum(vrd_Depth_Tree const* const self, uint32_t const root)
+{
+    return NULLPTR == root ? 0 : self->nodes[root].sum;
+} // subtree_sum
+
+
+static inline void
+update_sum(vrd_Depth_Tree* const self, uint32_t const root)
+{
+    self->nodes[root].sum = self->nodes[root].delta +
+                            subtree_sum(self, self->nodes[root].child[LEFT]) +
+                            subtree_sum(self, self->nodes[root].child[RIGHT]);
+} // update_sum
+
+
+// Links a new node into the tree, the sums along its path already
+// include it (see: add)
+//
+// Adapted from:
+// http://adtinfo.org/libavl.html/Inserting-into-an-AVL-Tree.html
+static void
+insert(vrd_Depth_Tree* const self, uint32_t const ptr)
+{
+    if (NULLPTR == self->root)
+    {
+        self->root = ptr;
+        return;
+    } // if
+
+    uint64_t path = 0;  // bit-path to first unbalanced ancestor
+    int len = 0;    // length of the path
+    unsigned int dir = 0;
+
+    uint32_t tmp = self->root;
+    uint32_t tmp_par = self->root;  // parent of tmp
+
+    uint32_t unbal = self->root;    // first unbalanced ancestor of tmp
+    uint32_t unbal_par = self->root;    // parent of unbalanced
+
+    while (NULLPTR != tmp)
+    {
+        if (0 != self->nodes[tmp].balance)
+        {
+            unbal_par = tmp_par;
+            unbal = tmp;
+            path = 0;
+            len = 0;
+        } // if
+
+        dir = self->nodes[ptr].key > self->nodes[tmp].key;
+        if (RIGHT == dir)
+        {
+            path |= (uint64_t) RIGHT << len;
+        } // if
+        len += 1;
+
+        tmp_par = tmp;
+        tmp = self->nodes[tmp].child[dir];
+    } // while
+
+    self->nodes[tmp_par].child[dir] = ptr;
+
+    tmp = unbal;
+    while (tmp != ptr)
+    {
+        if (LEFT == (path & RIGHT))
+        {
+            self->nodes[tmp].balance -= 1;
+        } // if
+        else
+        {
+            self->nodes[tmp].balance += 1;
+        } // else
+
+        tmp = self->nodes[tmp].child[path & RIGHT];
+        path >>= 1;
+    } // while
+
+    // Do the rotations if necessary: mirrored for either side
+    uint32_t root = NULLPTR;
+    int const sign = self->nodes[unbal].balance / 2;
+    if (0 == sign)
+    {
+        return;
+    } // if
+
+    unsigned int const side = 0 < sign ? RIGHT : LEFT;
+    uint32_t const child = self->nodes[unbal].child[side];
+    if (sign == self->nodes[child].balance)
+    {
+        root = child;
+        self->nodes[unbal].child[side] = self->nodes[child].child[!side];
+        self->nodes[child].child[!side] = unbal;
+        self->nodes[child].balance = 0;
+        self->nodes[unbal].balance = 0;
+
+        update_sum(self, unbal);
+        update_sum(self, child);
+    } // if
+    else
+    {
+        root = self->nodes[child].child[!side];
+        self->nodes[child].child[!side] = self->nodes[root].child[side];
+        self->nodes[root].child[side] = child;
+        self->nodes[unbal].child[side] = self->nodes[root].child[!side];
+        self->nodes[root].child[!side] = unbal;
+        if (sign == self->nodes[root].balance)
+        {
+            self->nodes[child].balance = 0;
+            self->nodes[unbal].balance = -sign;
+        } // if
+        else if (0 == self->nodes[root].balance)
+        {
+            self->nodes[child].balance = 0;
+            self->nodes[unbal].balance = 0;
+        } // if
+        else
+        {
+            self->nodes[child].balance = sign;
+            self->nodes[unbal].balance = 0;
+        } // else
+        self->nodes[root].balance = 0;
+
+        update_sum(self, child);
+        update_sum(self, unbal);
+        update_sum(self, root);
+    } // else
+
+    if (self->root == unbal)
+    {
+        self->root = root;
+        return;
+    } // if
+
+    self->nodes[unbal_par].child[unbal != self->nodes[unbal_par].child[LEFT]] = root;
+} // insert
+
+
+// Adds a change in depth at a position: to an existing breakpoint or to
+// a new one
+static int
+add(vrd_Depth_Tree* const self, size_t const position, uint32_t const delta)
+{
+    if (UINT32_MAX == self->next ||
+        (self->capacity < self->next && 0 != grow(self)))
+    {
+        return -1;
+    } // if
+
+    uint32_t tmp = self->root;
+    while (NULLPTR != tmp)
+    {
+        self->nodes[tmp].sum += delta;
+        if (position == self->nodes[tmp].key)
+        {
+            self->nodes[tmp].delta += delta;
+            return 0;
+        } // if
+        tmp = self->nodes[tmp].child[position > self->nodes[tmp].key];
+    } // while
+
+    uint32_t const ptr = self->next;
+    self->next += 1;
+
+    self->nodes[ptr].key = position;
+    self->nodes[ptr].delta = delta;
+    self->nodes[ptr].sum = delta;
+    self->nodes[ptr].balance = 0;
+    self->nodes[ptr].child[LEFT] = NULLPTR;
+    self->nodes[ptr].child[RIGHT] = NULLPTR;
+
+    insert(self, ptr);
+
+    return 0;
+} // add
+
+
+int
+vrd_Depth_tree_insert(vrd_Depth_Tree* const self,
+                      size_t const start,
+                      size_t const end,
+                      size_t const count)
+{
+    assert(NULL != self);
+
+    if (start >= end)
+    {
+        return 0;
+    } // if
+
+    int const err = add(self, start, count);
+    if (0 != err)
+    {
+        return err;
+    } // if
+    return add(self, end, -(uint32_t) count);
+} // vrd_Depth_tree_insert
+
+
+int
+vrd_Depth_tree_remove(vrd_Depth_Tree* const self,
+                      size_t const start,
+                      size_t const end,
+                      size_t const count)
+{
+    assert(NULL != self);
+
+    if (start >= end)
+    {
+        return 0;
+    } // if
+
+    int const err = add(self, start, -(uint32_t) count);
+    if (0 != err)
+    {
+        return err;
+    } // if
+    return add(self, end, count);
+} // vrd_Depth_tree_remove
+
+
+size_t
+vrd_Depth_tree_depth(vrd_Depth_Tree const* const self, size_t const position)
+{
+    assert(NULL != self);
+
+    uint32_t depth = 0;
+    uint32_t tmp = self->root;
+    while (NULLPTR != tmp)
+    {
+        if (self->nodes[tmp].key <= position)
+        {
+            depth += subtree_sum(self, self->nodes[tmp].child[LEFT]) + self->nodes[tmp].delta;
+            tmp = self->nodes[tmp].child[RIGHT];
+        } // if
+        else
+        {
+            tmp = self->nodes[tmp].child[LEFT];
+        } // else
+    } // while
+    return depth;
+} // vrd_Depth_tree_depth
+
+
+void
+vrd_Depth_tree_depth_batch(vrd_Depth_Tree const* const self,
+                           size_t const n,
+                           size_t const position[n],
+                           size_t depth[n])
+{
+    assert(NULL != self);
+    assert(VRD_BATCH_SIZE >= n);
+
+    uint32_t tmp[VRD_BATCH_SIZE];
+    uint32_t left[VRD_BATCH_SIZE];  // a subtree to add in the next round
+    uint32_t sum[VRD_BATCH_SIZE];
+    for (size_t i = 0; i < n; ++i)
+    {
+        tmp[i] = self->root;
+        left[i] = NULLPTR;
+        sum[i] = 0;
+    } // for
+
+    // one level of every descent per round, the nodes of the next round
+    // are prefetched
+    bool active = NULLPTR != self->root;
+    while (active)
+    {
+        active = false;
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum[i] += subtree_sum(self, left[i]);
+            left[i] = NULLPTR;
+            if (NULLPTR == tmp[i])
+            {
+                continue;
+            } // if
+
+            struct Node const* const node = &self->nodes[tmp[i]];
+            bool const before = node->key <= position[i];
+            if (before)
+            {
+                sum[i] += node->delta;
+                left[i] = node->child[LEFT];
+                __builtin_prefetch(&self->nodes[left[i]]);
+            } // if
+            tmp[i] = node->child[before];
+            __builtin_prefetch(&self->nodes[tmp[i]]);
+            active = active || NULLPTR != tmp[i] || NULLPTR != left[i];
+        } // for
+    } // while
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        depth[i] = sum[i];
+    } // for
+} // vrd_Depth_tree_depth_batch
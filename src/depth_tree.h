@@ -0,0 +1,92 @@
+/**
+ * @file: depth_tree.h
+ *
+ * Defines a step function of the coverage depth along a reference: the
+ * change in depth at every breakpoint (the start or the end of a region)
+ * in a balanced tree of breakpoints that keeps the total change of each
+ * subtree. The depth at a position is the sum of the changes up to it,
+ * which takes O(log n) time, where n is the number of distinct
+ * breakpoints.
+ *
+ * Breakpoints are never removed: removing a region only cancels its
+ * changes.
+ */
+
+
+#ifndef VRD_DEPTH_TREE_H
+#define VRD_DEPTH_TREE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#include <stddef.h>     // size_t
+
+
+typedef struct vrd_Depth_Tree vrd_Depth_Tree;
+
+
+vrd_Depth_Tree*
+vrd_Depth_tree_init(size_t const capacity);
+
+
+void
+vrd_Depth_tree_destroy(vrd_Depth_Tree** const self);
+
+
+/**
+ * Remove all breakpoints.
+ */
+void
+vrd_Depth_tree_clear(vrd_Depth_Tree* const self);
+
+
+/**
+ * Add a region [start, end) with an allele count. Empty regions do not
+ * change the depth.
+ *
+ * @return 0 on success, an errno or -1 if a breakpoint cannot be added;
+ *         the depths are inconsistent afterwards.
+ */
+int
+vrd_Depth_tree_insert(vrd_Depth_Tree* const self,
+                      size_t const start,
+                      size_t const end,
+                      size_t const count);
+
+
+/**
+ * Cancel a region [start, end) that was added before.
+ */
+int
+vrd_Depth_tree_remove(vrd_Depth_Tree* const self,
+                      size_t const start,
+                      size_t const end,
+                      size_t const count);
+
+
+/**
+ * The allele count of the regions that contain a position.
+ */
+size_t
+vrd_Depth_tree_depth(vrd_Depth_Tree const* const self, size_t const position);
+
+
+/**
+ * The depths at up to VRD_BATCH_SIZE positions, the descents advance in
+ * lockstep.
+ */
+void
+vrd_Depth_tree_depth_batch(vrd_Depth_Tree const* const self,
+                           size_t const n,
+                           size_t const position[n],
+                           size_t depth[n]);
+
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
@@ -32,6 +32,13 @@ umax(size_t const a, size_t const b)
 } // umax
 
 
+static inline size_t
+umin(size_t const a, size_t const b)
+{
+    return a < b ? a : b;
+} // umin
+
+
 static inline int
 bittest(size_t const n, int const i)
 {
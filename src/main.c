@@ -56,7 +56,7 @@ main(int argc, char* argv[])
         goto error;
     } // if
 
-    if (929381 != vrd_coverage_from_file(istream, cov, 1))
+    if (929381 != vrd_coverage_from_file(istream, cov, 1, NULL))
     {
         (void) fprintf(stderr, "vrd_coverage_from_file() failed\n");
         goto error;
@@ -75,7 +75,7 @@ main(int argc, char* argv[])
         goto error;
     } // if
 
-    if (5091015 != vrd_variants_from_file(istream, snv, mnv, seq, 1))
+    if (5091015 != vrd_variants_from_file(istream, snv, mnv, seq, 1, NULL))
     {
         (void) fprintf(stderr, "vrd_variants_from_file() failed\n");
         goto error;
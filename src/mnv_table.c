@@ -12,7 +12,8 @@
 #define VRD_TYPENAME MNV
 
 
-#include "template_table.inc"   // tree_from_reference, vrd_MNV_table_*
+#include "template_table.inc"   // retract_clear, tree_from_reference,
+                                // vrd_MNV_table_*
 
 
 int
@@ -60,6 +61,64 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query)(VRD_TEMPLATE(VRD_TYPENAME, _Table) cons
 } // vrd_MNV_table_query
 
 
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                               size_t const len,
+                                               char const reference[len],
+                                               size_t const n,
+                                               size_t const start[n],
+                                               size_t const end[n],
+                                               size_t const inserted[n],
+                                               bool const homozygous,
+                                               vrd_AVL_Tree const* const subset,
+                                               size_t result[n])
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = -1;
+        } // for
+        return -1;
+    } // if
+
+    VRD_TEMPLATE(VRD_TYPENAME, _tree_query_batch)(elem->data, n, start, end, inserted, homozygous, subset, result);
+    return 0;
+} // vrd_MNV_table_query_batch
+
+
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                size_t const len,
+                                                char const reference[len],
+                                                size_t const n,
+                                                size_t const start[n],
+                                                size_t const end[n],
+                                                size_t const inserted[n],
+                                                bool const homozygous,
+                                                vrd_AVL_Tree const* const subset,
+                                                size_t result[n])
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = -1;
+        } // for
+        return -1;
+    } // if
+
+    VRD_TEMPLATE(VRD_TYPENAME, _tree_query_sorted)(elem->data, n, start, end, inserted, homozygous, subset, result);
+    return 0;
+} // vrd_MNV_table_query_sorted
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                                 size_t const len_ref,
@@ -82,6 +141,27 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tabl
 } // vrd_MNV_table_query_region
 
 
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_region_count)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                      size_t const len,
+                                                      char const reference[len],
+                                                      size_t const start,
+                                                      size_t const end,
+                                                      bool const homozygous,
+                                                      vrd_AVL_Tree const* const subset)
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        return -1;
+    } // if
+
+    return VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region_count)(elem->data, start, end, homozygous, subset);
+} // vrd_MNV_table_query_region_count
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_remove_seq)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
                                               vrd_AVL_Tree const* const subset,
@@ -99,6 +179,23 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_remove_seq)(VRD_TEMPLATE(VRD_TYPENAME, _Table)
 } // vrd_MNV_table_remove_seq
 
 
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_compact_seq)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
+                                               vrd_Seq_Table* const seq_table)
+{
+    assert(NULL != self);
+
+    if (NULL == self->retracted || self->frozen)
+    {
+        return 0;
+    } // if
+
+    size_t const count = VRD_TEMPLATE(VRD_TYPENAME, _table_remove_seq)(self, self->retracted, seq_table);
+    retract_clear(self);
+    return count;
+} // vrd_MNV_table_compact_seq
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_export)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                           FILE* stream,
@@ -1,24 +1,33 @@
 #include <assert.h>     // assert
 #include <stddef.h>     // NULL, size_t
 #include <stdbool.h>    // bool
-#include <stdint.h>     // int32_t, uint32_t
+#include <stdint.h>     // UINT32_MAX, int32_t, uint32_t
 #include <stdio.h>      // FILE, fprintf
+#include <string.h>     // memcpy
 
 #include "../include/avl_tree.h"    // vrd_AVL_Tree, vrd_AVL_tree_*
-#include "../include/constants.h"   // VRD_HOMOZYGOUS
+#include "../include/constants.h"   // VRD_HOMOZYGOUS, VRD_MAX_*
 #include "../include/seq_table.h"   // vrd_Seq_Table, vrd_Seq_table_*
 #include "../include/template.h"    // VRD_TEMPLATE
+#include "imath.h"      // umin
 #include "mnv_tree.h"   // vrd_MNV_Tree, vrd_MNV_tree_*
-#include "tree.h"       // NULLPTR, LEFT, RIGHT
+#include "tree.h"       // NULLPTR, LEFT, RIGHT, VRD_*_SIZE
 
 
 #define VRD_TYPENAME MNV
 
 
+// Built with VRD_SUBTREE_SUMS (`make OPTIONS=VRD_SUBTREE_SUMS`), the nodes
+// keep the allele counts of their subtrees, such that the allele count of
+// a variant or a region takes O(log n) time (see:
+// vrd_*_tree_query_region_count)
+#ifdef VRD_SUBTREE_SUMS
+#define VRD_SUM
+#endif
+
+
 struct VRD_TEMPLATE(VRD_TYPENAME, _Node)
 {
-    uint32_t child[2];
-
     uint32_t key       : 28;    // start
     uint32_t count     :  4;
 
@@ -32,12 +41,143 @@ struct VRD_TEMPLATE(VRD_TYPENAME, _Node)
     uint32_t unused    :  4;    // For consistency with SNVs, we don't need the remaining bits (yet)
 
     uint32_t inserted;
+
+#ifdef VRD_SUM
+    uint32_t sum;               // the allele count of the subtree
+    uint32_t sum_homozygous;    // idem, of the homozygous nodes
+#endif
+
+    uint32_t child[2];
 }; // vrd_MNV_Node
 
 
+// A node of a frozen tree (see: vrd_MNV_tree_freeze): a node without its
+// child pointers. The layouts agree up to there, such that query results
+// of either tree can be unpacked alike.
+struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)
+{
+    uint32_t key       : 28;    // start
+    uint32_t count     :  4;
+
+    uint32_t end;
+    uint32_t max;      // unused, the index holds the largest ends
+
+    int32_t  balance   :  3;    // unused
+    uint32_t sample_id : 29;
+
+    uint32_t phase     : 28;
+    uint32_t unused    :  4;
+
+    uint32_t inserted;
+}; // vrd_MNV_Frozen
+
+
+static inline void
+node_freeze(struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)* const frozen,
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node)
+{
+    frozen->key = node->key;
+    frozen->count = node->count;
+    frozen->end = node->end;
+    frozen->max = node->end;
+    frozen->balance = 0;
+    frozen->sample_id = node->sample_id;
+    frozen->phase = node->phase;
+    frozen->unused = 0;
+    frozen->inserted = node->inserted;
+} // node_freeze
+
+
+// The nodes of a frozen tree with equal keys are grouped by variant
+#define VRD_VARIANT
+
+
+static inline int
+variant_compare(struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) const* const lhs,
+                struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) const* const rhs)
+{
+    if (lhs->key != rhs->key)
+    {
+        return lhs->key < rhs->key ? -1 : 1;
+    } // if
+    if (lhs->end != rhs->end)
+    {
+        return lhs->end < rhs->end ? -1 : 1;
+    } // if
+    return (lhs->inserted > rhs->inserted) - (lhs->inserted < rhs->inserted);
+} // variant_compare
+
+
+// Compares the variant of a node to the one at [start, end)
+static inline int
+node_variant(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node,
+             size_t const start,
+             size_t const end,
+             size_t const inserted)
+{
+    if (node->key != start)
+    {
+        return node->key < start ? -1 : 1;
+    } // if
+    if (node->end != end)
+    {
+        return node->end < end ? -1 : 1;
+    } // if
+    return (node->inserted > inserted) - (node->inserted < inserted);
+} // node_variant
+
+
+// The nodes of a tree are ordered as those of a frozen tree: the
+// carriers of a variant are consecutive in key order
+static inline int
+node_compare(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const lhs,
+             struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const rhs)
+{
+    int const cmp = node_variant(lhs, rhs->key, rhs->end, rhs->inserted);
+    if (0 != cmp)
+    {
+        return cmp;
+    } // if
+    return (lhs->sample_id > rhs->sample_id) - (lhs->sample_id < rhs->sample_id);
+} // node_compare
+
+
+// the fields of a packed node: key, length, count, sample_id, phase, inserted
+#define VRD_FIELDS 6
+
+
+static inline void
+node_pack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node,
+          uint32_t field[VRD_FIELDS])
+{
+    field[0] = node->key;
+    field[1] = node->end - node->key;
+    field[2] = node->count;
+    field[3] = node->sample_id;
+    field[4] = node->phase;
+    field[5] = node->inserted;
+} // node_pack
+
+
+static inline void
+node_unpack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node)* const node,
+            uint32_t const field[VRD_FIELDS])
+{
+    node->key = field[0];
+    node->end = field[0] + field[1];
+    node->count = field[2];
+    node->sample_id = field[3];
+    node->phase = field[4];
+    node->unused = 0;
+    node->inserted = field[5];
+} // node_unpack
+
+
 #define VRD_INTERVAL
 #include "template_tree.inc"    // vrd_MNV_tree_*
 #undef VRD_INTERVAL
+#undef VRD_FIELDS
+#undef VRD_VARIANT
 
 
 void
@@ -49,13 +189,15 @@ VRD_TEMPLATE(VRD_TYPENAME, _unpack)(void* const ptr,
                                     size_t* const phase,
                                     size_t* const inserted)
 {
-    struct vrd_MNV_Node const* const node = ptr;
-    *start = node->key;
-    *end = node->end;
-    *count = node->count;
-    *sample_id = node->sample_id;
-    *phase = node->phase == VRD_HOMOZYGOUS ? (size_t) -1 : node->phase;
-    *inserted = node->inserted;
+    // a node or a frozen node
+    struct vrd_MNV_Frozen node;
+    memcpy(&node, ptr, sizeof(node));
+    *start = node.key;
+    *end = node.end;
+    *count = node.count;
+    *sample_id = node.sample_id;
+    *phase = node.phase == VRD_HOMOZYGOUS ? (size_t) -1 : node.phase;
+    *inserted = node.inserted;
 } // vrd_MNV_unpack
 
 
@@ -70,7 +212,8 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 {
     assert(NULL != self);
 
-    if (UINT32_MAX == self->next || self->capacity < self->next)
+    if (UINT32_MAX == self->next ||
+        (self->capacity < self->next && 0 != grow(self)))
     {
         return -1;
     } // if
@@ -95,72 +238,193 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 } // vrd_MNV_tree_insert
 
 
+// The carriers of a variant are a contiguous range of the tree
 static size_t
 query(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
-      size_t const root,
+      uint32_t const root,
       size_t const start,
       size_t const end,
       size_t const inserted,
       bool const homozygous,
       vrd_AVL_Tree const* const subset)
 {
-    if (NULLPTR == root || self->nodes[root].max < start)
-    {
-        return 0;
-    } // if
-
-    if (self->nodes[root].key > start)
-    {
-        return query(self, self->nodes[root].child[LEFT], start, end, inserted, homozygous, subset);
-    } // if
+    uint32_t stack[VRD_STACK_SIZE] = {root};
+    size_t top = NULLPTR != root;
 
     size_t res = 0;
-    // TODO: match inserted; IUPAC, overlap, ...
-    if (start == self->nodes[root].key &&
-        end == self->nodes[root].end &&
-        inserted == self->nodes[root].inserted &&
-        (!homozygous || (homozygous && self->nodes[root].phase == VRD_HOMOZYGOUS)) &&
-        (NULL == subset || vrd_AVL_tree_is_element(subset, self->nodes[root].sample_id)))
+    while (0 < top)
     {
-        res = self->nodes[root].count;
-    } // if
-
-    return res + query(self, self->nodes[root].child[LEFT], start, end, inserted, homozygous, subset) +
-                 query(self, self->nodes[root].child[RIGHT], start, end, inserted, homozygous, subset);
+        top -= 1;
+        uint32_t ptr = stack[top];
+        while (NULLPTR != ptr)
+        {
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[ptr];
+            // TODO: match inserted; IUPAC, overlap, ...
+            int const cmp = node_variant(node, start, end, inserted);
+            if (0 != cmp)
+            {
+                ptr = node->child[0 > cmp];
+                continue;
+            } // if
+
+            if ((!homozygous || node->phase == VRD_HOMOZYGOUS) &&
+                selected(self, subset, node->sample_id))
+            {
+                res += node->count;
+            } // if
+
+            // the range continues on both sides
+            if (NULLPTR != node->child[RIGHT])
+            {
+                stack[top] = node->child[RIGHT];
+                top += 1;
+            } // if
+            ptr = node->child[LEFT];
+        } // while
+    } // while
+    return res;
 } // query
 
 
+#ifdef VRD_SUM
+// The allele count of the nodes before the variant (or up to and
+// including it)
+static uint32_t
+sum_variant(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+            size_t const start,
+            size_t const end,
+            size_t const inserted,
+            bool const inclusive,
+            bool const homozygous)
+{
+    uint32_t sum = 0;
+    uint32_t tmp = self->root;
+    while (NULLPTR != tmp)
+    {
+        int const cmp = node_variant(&self->nodes[tmp], start, end, inserted);
+        if (0 > cmp || (inclusive && 0 == cmp))
+        {
+            sum += subtree_sum(self, self->nodes[tmp].child[LEFT], homozygous) +
+                   node_sum(self, tmp, homozygous);
+            tmp = self->nodes[tmp].child[RIGHT];
+        } // if
+        else
+        {
+            tmp = self->nodes[tmp].child[LEFT];
+        } // else
+    } // while
+    return sum;
+} // sum_variant
+#endif
+
+
+// Collects the nodes in the region in pre-order
 static size_t
 query_region(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
-             size_t const root,
+             uint32_t const root,
              size_t const start,
              size_t const end,
              vrd_AVL_Tree const* const subset,
-             size_t const next,
              size_t const len,
              void* result[len])
 {
-    if (NULLPTR == root || next >= len || self->nodes[root].max < start)
-    {
-        return next;
-    } // if
+    uint32_t stack[VRD_STACK_SIZE] = {root};
+    size_t top = NULLPTR != root;
 
-    if (self->nodes[root].key > end)
+    size_t next = 0;
+    while (0 < top && next < len)
     {
-        return query_region(self, self->nodes[root].child[LEFT], start, end, subset, next, len, result);
-    } // if
+        top -= 1;
+        uint32_t ptr = stack[top];
+        while (NULLPTR != ptr && next < len && self->nodes[ptr].max >= start)
+        {
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[ptr];
+            if (node->key <= end)
+            {
+                if (start <= node->key && end > node->end &&
+                    selected(self, subset, node->sample_id))
+                {
+                    result[next] = (void*) node;
+                    next += 1;
+                } // if
+
+                if (NULLPTR != node->child[RIGHT])
+                {
+                    stack[top] = node->child[RIGHT];
+                    top += 1;
+                } // if
+            } // if
+            ptr = node->child[LEFT];
+        } // while
+    } // while
+    return next;
+} // query_region
 
-    size_t match = 0;
-    if (start <= self->nodes[root].key && end > self->nodes[root].end &&
-        (NULL == subset || vrd_AVL_tree_is_element(subset, self->nodes[root].sample_id)))
-    {
-        result[next] = (void*) &self->nodes[root];
-        match = 1;
-    } // if
 
-    size_t const count = query_region(self, self->nodes[root].child[LEFT], start, end, subset, next + match, len, result);
-    return query_region(self, self->nodes[root].child[RIGHT], start, end, subset, count, len, result);
-} // query_region
+// Visits the distinct variants that start at `start`, the carriers of a
+// variant only for a subset or with retracted samples
+static size_t
+query_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+             size_t const start,
+             size_t const end,
+             size_t const inserted,
+             bool const homozygous,
+             vrd_AVL_Tree const* const subset)
+{
+    size_t res = 0;
+    for (size_t i = frozen_variant(self, frozen_lower_bound(self, start));
+         i < self->variant_count && self->frozen[self->variants[i].first].key == start;
+         ++i)
+    {
+        struct Variant const* const variant = &self->variants[i];
+        if (end != self->frozen[variant->first].end ||
+            inserted != self->frozen[variant->first].inserted)
+        {
+            continue;
+        } // if
+
+        if (NULL == subset && NULL == self->retracted)
+        {
+            res += homozygous ? variant->homozygous : variant->count;
+            continue;
+        } // if
+
+        for (size_t j = variant->first; j < variant->first + variant->carriers; ++j)
+        {
+            if ((!homozygous || (homozygous && self->frozen[j].phase == VRD_HOMOZYGOUS)) &&
+                selected(self, subset, self->frozen[j].sample_id))
+            {
+                res += self->frozen[j].count;
+            } // if
+        } // for
+    } // for
+    return res;
+} // query_frozen
+
+
+// The regions contained in [start, end) start in it: a sequential scan
+static size_t
+query_region_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                    size_t const start,
+                    size_t const end,
+                    vrd_AVL_Tree const* const subset,
+                    size_t const len,
+                    void* result[len])
+{
+    size_t next = 0;
+    for (size_t i = frozen_lower_bound(self, start);
+         i < self->base.entries && next < len && self->frozen[i].key <= end;
+         ++i)
+    {
+        if (end > self->frozen[i].end &&
+            selected(self, subset, self->frozen[i].sample_id))
+        {
+            result[next] = (void*) &self->frozen[i];
+            next += 1;
+        } // if
+    } // for
+    return next;
+} // query_region_frozen
 
 
 size_t
@@ -173,7 +437,13 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)
 {
     assert(NULL != self);
 
-    return query_region(self, self->root, start, end, subset, 0, len, result);
+    VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const tree = current(self);
+    if (NULL != tree->frozen)
+    {
+        return query_region_frozen(tree, start, end, subset, len, result);
+    } // if
+
+    return query_region(self, self->root, start, end, subset, len, result);
 } // vrd_MNV_tree_query_region
 
 
@@ -187,35 +457,147 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const*
 {
     assert(NULL != self);
 
+    VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const tree = current(self);
+    if (NULL != tree->frozen)
+    {
+        return query_frozen(tree, start, end, inserted, homozygous, subset);
+    } // if
+
+#ifdef VRD_SUM
+    if (NULL == subset && NULL == self->retracted && sums_exact(self))
+    {
+        return (uint32_t) (sum_variant(self, start, end, inserted, true, homozygous) -
+                           sum_variant(self, start, end, inserted, false, homozygous));
+    } // if
+#endif
+
     return query(self, self->root, start, end, inserted, homozygous, subset);
 } // vrd_MNV_tree_query
 
 
-static size_t
-traverse_seq(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self,
-             uint32_t const root,
-             int const depth,
-             uint64_t const path,
-             vrd_AVL_Tree const* const subset,
-             vrd_Seq_Table* const seq_table)
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                              size_t const n,
+                                              size_t const start[n],
+                                              size_t const end[n],
+                                              size_t const inserted[n],
+                                              bool const homozygous,
+                                              vrd_AVL_Tree const* const subset,
+                                              size_t result[n])
 {
-    if (NULLPTR == root)
+    assert(NULL != self);
+
+    // the descents interleave on the subtree sums, the range walks of a
+    // subset do not
+#ifdef VRD_SUM
+    if (NULL != current(self)->frozen || NULL != subset || NULL != self->retracted ||
+        !sums_exact(self))
+#endif
     {
-        return 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = VRD_TEMPLATE(VRD_TYPENAME, _tree_query)(self, start[i], end[i], inserted[i], homozygous, subset);
+        } // for
+        return;
     } // if
 
-    size_t count = 0;
+#ifdef VRD_SUM
+    // the carriers of a variant are between its first and its last
+    // possible sample
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Node) first[VRD_BATCH_SIZE];
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Node) last[VRD_BATCH_SIZE];
+    uint32_t before[VRD_BATCH_SIZE];
+    uint32_t upto[VRD_BATCH_SIZE];
+    for (size_t i = 0; i < n; i += VRD_BATCH_SIZE)
+    {
+        size_t const count = umin(VRD_BATCH_SIZE, n - i);
+        for (size_t j = 0; j < count; ++j)
+        {
+            first[j].key = last[j].key = start[i + j];
+            first[j].end = last[j].end = end[i + j];
+            first[j].inserted = last[j].inserted = inserted[i + j];
+            first[j].sample_id = 0;
+            last[j].sample_id = VRD_MAX_SAMPLE_ID;
+        } // for
+
+        sum_before_batch(self, count, first, false, homozygous, before);
+        sum_before_batch(self, count, last, true, homozygous, upto);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            // variants that do not fit a node are not in the tree
+            result[i + j] = VRD_MAX_POSITION < start[i + j] || UINT32_MAX < end[i + j] ||
+                            UINT32_MAX < inserted[i + j] ?
+                                0 : (uint32_t) (upto[j] - before[j]);
+        } // for
+    } // for
+#endif
+} // vrd_MNV_tree_query_batch
+
+
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                               size_t const n,
+                                               size_t const start[n],
+                                               size_t const end[n],
+                                               size_t const inserted[n],
+                                               bool const homozygous,
+                                               vrd_AVL_Tree const* const subset,
+                                               size_t result[n])
+{
+    assert(NULL != self);
 
-    count += traverse_seq(self, self->nodes[root].child[LEFT], depth + 1, (path << 1) + LEFT, subset, seq_table);
-    count += traverse_seq(self, self->nodes[root].child[RIGHT], depth + 1, (path << 1) + RIGHT, subset, seq_table);
+    struct Cursor cursor;
+    cursor_init(&cursor, self);
 
-    if (vrd_AVL_tree_is_element(subset, self->nodes[root].sample_id))
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) probe = {0};
+    for (size_t i = 0; i < n; ++i)
     {
-        node_remove(self, depth, path);
-        vrd_Seq_table_remove(seq_table, self->nodes[root].inserted);
-        count += 1;
+        // variants that do not fit a node are not in the tree
+        if (VRD_MAX_POSITION < start[i] || UINT32_MAX < end[i] || UINT32_MAX < inserted[i])
+        {
+            result[i] = 0;
+            continue;
+        } // if
+
+        probe.key = start[i];
+        probe.end = end[i];
+        probe.inserted = inserted[i];
+        result[i] = cursor_variant(&cursor, &probe, homozygous, subset);
+    } // for
+} // vrd_MNV_tree_query_sorted
+
+
+struct Removal
+{
+    vrd_AVL_Tree const* subset;
+    vrd_Seq_Table* seq_table;
+}; // Removal
+
+
+static bool
+in_subset_seq(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self,
+              uint32_t const ptr,
+              void* const arg)
+{
+    struct Removal const* const removal = arg;
+    if (!vrd_AVL_tree_is_element(removal->subset, self->nodes[ptr].sample_id))
+    {
+        return false;
     } // if
-    return count;
+
+    vrd_Seq_table_remove(removal->seq_table, self->nodes[ptr].inserted);
+    return true;
+} // in_subset_seq
+
+
+static size_t
+traverse_seq(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self,
+             vrd_AVL_Tree const* const subset,
+             vrd_Seq_Table* const seq_table)
+{
+    struct Removal removal = {subset, seq_table};
+    return remove_if(self, in_subset_seq, &removal);
 } // traverse_seq
 
 
@@ -226,9 +608,39 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_remove_seq)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)*
 {
     assert(NULL != self);
 
-    size_t const count = traverse_seq(self, self->root, 0, 0, subset, seq_table);
-    balance(self);
-    update_avl(self, self->root, 0);
+    // the nodes of a bulk load are removed as well
+    if (NULL != self->frozen ||
+        0 != VRD_TEMPLATE(VRD_TYPENAME, _tree_merge)(self))
+    {
+        return 0;
+    } // if
+
+    size_t count = 0;
+    if (NULL != self->same)
+    {
+        for (size_t i = 0; i < self->samples; ++i)
+        {
+            if (NULLPTR == self->first[i] || !vrd_AVL_tree_is_element(subset, i))
+            {
+                continue;
+            } // if
+
+            for (uint32_t ptr = self->first[i]; NULLPTR != ptr; ptr = self->same[ptr])
+            {
+                vrd_Seq_table_remove(seq_table, self->nodes[ptr].inserted);
+            } // for
+        } // for
+        count = postings_mark(self, subset);
+    } // if
+    else
+    {
+        count = traverse_seq(self, subset, seq_table);
+    } // else
+    if (0 < count)
+    {
+        self->base.generation += 1;
+        compact(self);
+    } // if
 
     return count;
 } // vrd_MNV_tree_remove_seq
@@ -242,26 +654,58 @@ export(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
        char const reference[len],
        vrd_Seq_Table const* const seq_table)
 {
-    if (NULLPTR == root)
+    uint32_t stack[VRD_STACK_SIZE];
+    size_t top = 0;
+
+    size_t count = 0;
+    uint32_t ptr = root;
+    while (NULLPTR != ptr || 0 < top)
     {
-        return 0;
-    } // if
+        // in key order: the left spine first
+        for (; NULLPTR != ptr; ptr = self->nodes[ptr].child[LEFT])
+        {
+            stack[top] = ptr;
+            top += 1;
+        } // for
+        top -= 1;
+        struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[stack[top]];
 
-    size_t count = export(self, self->nodes[root].child[LEFT], stream, len, reference, seq_table);
+        char* inserted = NULL;
+        size_t const inserted_len = vrd_Seq_table_key(seq_table, node->inserted, &inserted);
 
-    char* inserted = NULL;
-    size_t const inserted_len = vrd_Seq_table_key(seq_table, self->nodes[root].inserted, &inserted);
+        int const phase = node->phase == VRD_HOMOZYGOUS ? -1 : (int) node->phase;
 
-    int const phase = self->nodes[root].phase == VRD_HOMOZYGOUS ? -1 : (int) self->nodes[root].phase;
+        (void) fprintf(stream, "%s\t%u\t%u\t%u\t%d\t%zu\t%s\n", reference, node->key, node->end, node->count, phase, inserted_len - 1, inserted_len == 1 ? "." : inserted);
 
-    (void) fprintf(stream, "%s\t%u\t%u\t%u\t%d\t%zu\t%s\n", reference, self->nodes[root].key, self->nodes[root].end, self->nodes[root].count, phase, inserted_len - 1, inserted_len == 1 ? "." : inserted);
+        free(inserted);
 
-    free(inserted);
+        count += 1;
+        ptr = node->child[RIGHT];
+    } // while
+    return count;
+} // export
 
-    count += export(self, self->nodes[root].child[RIGHT], stream, len, reference, seq_table);
 
-    return count + 1;
-} // export
+static size_t
+export_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+              FILE* stream,
+              size_t const len,
+              char const reference[len],
+              vrd_Seq_Table const* const seq_table)
+{
+    for (size_t i = 0; i < self->base.entries; ++i)
+    {
+        char* inserted = NULL;
+        size_t const inserted_len = vrd_Seq_table_key(seq_table, self->frozen[i].inserted, &inserted);
+
+        int const phase = self->frozen[i].phase == VRD_HOMOZYGOUS ? -1 : (int) self->frozen[i].phase;
+
+        (void) fprintf(stream, "%s\t%u\t%u\t%u\t%d\t%zu\t%s\n", reference, self->frozen[i].key, self->frozen[i].end, self->frozen[i].count, phase, inserted_len - 1, inserted_len == 1 ? "." : inserted);
+
+        free(inserted);
+    } // for
+    return self->base.entries;
+} // export_frozen
 
 
 size_t
@@ -275,8 +719,14 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_export)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const
     assert(NULL != stream);
     assert(NULL != seq_table);
 
+    if (NULL != self->frozen)
+    {
+        return export_frozen(self, stream, len, reference, seq_table);
+    } // if
+
     return export(self, self->root, stream, len, reference, seq_table);
 } // vrd_MNV_export
 
 
+#undef VRD_SUM
 #undef VRD_TYPENAME
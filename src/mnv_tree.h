@@ -51,6 +51,42 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const*
                                         vrd_AVL_Tree const* const subset);
 
 
+/**
+ * The allele counts of `n` variants, as with vrd_*_tree_query(). The
+ * lookups of a batch descend the tree in lockstep to overlap their
+ * cache misses; without the subtree sums (see: VRD_SUBTREE_SUMS), with a
+ * subset, with retracted samples or for a frozen tree they are answered
+ * one by one.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                              size_t const n,
+                                              size_t const start[n],
+                                              size_t const end[n],
+                                              size_t const inserted[n],
+                                              bool const homozygous,
+                                              vrd_AVL_Tree const* const subset,
+                                              size_t result[n]);
+
+
+/**
+ * The allele counts of `n` variants, as with vrd_*_tree_query(), for
+ * variants in the order of the tree (by position, then by inserted
+ * sequence): a single forward pass over the tree answers all of them.
+ * A variant that is not after the previous one starts a new pass, so
+ * unsorted variants are answered correctly, only slower.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                               size_t const n,
+                                               size_t const start[n],
+                                               size_t const end[n],
+                                               size_t const inserted[n],
+                                               bool const homozygous,
+                                               vrd_AVL_Tree const* const subset,
+                                               size_t result[n]);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
                                                size_t const start,
@@ -60,6 +96,20 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)
                                                void* result[len]);
 
 
+/**
+ * The allele count of the MNVs that start in the region [start, end),
+ * of only the homozygous ones if `homozygous` is set. With the subtree
+ * sums (see: VRD_SUBTREE_SUMS) and without a subset this takes O(log n)
+ * time, otherwise the nodes in the region are counted.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region_count)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                                     size_t const start,
+                                                     size_t const end,
+                                                     bool const homozygous,
+                                                     vrd_AVL_Tree const* const subset);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _tree_remove_seq)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self,
                                              vrd_AVL_Tree const* const subset,
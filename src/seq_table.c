@@ -1,11 +1,13 @@
 #include <assert.h>     // assert
 #include <errno.h>      // errno
+#include <pthread.h>    // pthread_mutex_*
 #include <stddef.h>     // NULL, size_t
 #include <stdint.h>     // UINT32_MAX
-#include <stdio.h>      // FILE, FILENAME_MAX, fclose, fopen, fread
-                        // fwrite, snprintf
-#include <stdlib.h>     // free, malloc
+#include <stdio.h>      // FILE, fread, fwrite
+#include <stdlib.h>     // free, malloc, realloc
 
+#include "../include/checkpoint.h"  // VRD_CHECKPOINT_*, vrd_Checkpoint,
+                                    // vrd_checkpoint_*
 #include "../include/diagnostics.h"     // vrd_Diagnostics
 #include "../include/seq_table.h"   // vrd_Seq_Table
 #include "../include/trie.h"        // vrd_Trie_Node, vrd_Trie, vrd_trie_*
@@ -22,6 +24,7 @@ struct Free_Node
 struct vrd_Seq_Table
 {
     vrd_Trie* trie;
+    pthread_mutex_t lock;   // see: vrd_Seq_table_lock
 
     size_t capacity;
     struct Free_Node* free_list;
@@ -192,10 +195,20 @@ vrd_Seq_table_init(size_t const capacity)
         return NULL;
     } // if
 
+    int const err = pthread_mutex_init(&table->lock, NULL);
+    if (0 != err)
+    {
+        vrd_trie_destroy(&table->trie);
+        free(table);
+        errno = err;
+        return NULL;
+    } // if
+
     table->capacity = capacity;
     table->free_list = free_node_init(0, capacity, NULL);
     if (NULL == table->free_list)
     {
+        (void) pthread_mutex_destroy(&table->lock);
         vrd_trie_destroy(&table->trie);
         free(table);
         return NULL;
@@ -215,11 +228,30 @@ vrd_Seq_table_destroy(vrd_Seq_Table** const self)
 
     vrd_trie_destroy(&(*self)->trie);
     free_list_destroy(&(*self)->free_list);
+    (void) pthread_mutex_destroy(&(*self)->lock);
     free(*self);
     *self = NULL;
 } // vrd_Seq_table_destroy
 
 
+void
+vrd_Seq_table_lock(vrd_Seq_Table* const self)
+{
+    assert(NULL != self);
+
+    (void) pthread_mutex_lock(&self->lock);
+} // vrd_Seq_table_lock
+
+
+void
+vrd_Seq_table_unlock(vrd_Seq_Table* const self)
+{
+    assert(NULL != self);
+
+    (void) pthread_mutex_unlock(&self->lock);
+} // vrd_Seq_table_unlock
+
+
 vrd_Trie_Node*
 vrd_Seq_table_insert(vrd_Seq_Table* const self,
                      size_t const len,
@@ -311,19 +343,14 @@ vrd_Seq_table_remove(vrd_Seq_Table* const self, size_t const elem)
 
 
 int
-vrd_Seq_table_read(vrd_Seq_Table* const self,
-                   char const* const path)
+vrd_Seq_table_load(vrd_Seq_Table* const self,
+                   vrd_Checkpoint* const checkpoint)
 {
     assert(NULL != self);
+    assert(NULL != checkpoint);
 
-    char filename[FILENAME_MAX] = {'\0'};
-    size_t const buf_size = FILENAME_MAX;
-    if (0 >= snprintf(filename, buf_size, "%s.idx", path))
-    {
-        return errno;
-    } // if
-
-    FILE* stream = fopen(filename, "rb");
+    size_t section_size = 0;
+    FILE* const stream = vrd_checkpoint_find(checkpoint, "Seq", VRD_CHECKPOINT_INDEX, &section_size, NULL);
     if (NULL == stream)
     {
         return errno;
@@ -343,9 +370,12 @@ vrd_Seq_table_read(vrd_Seq_Table* const self,
         goto error;
     } // if
 
-    free(self->free_list);
-    self->free_list = NULL;
+    // the free list and the index are rebuilt in a single pass: the
+    // sequences are stored in index order, the gaps are free
+    free_list_destroy(&self->free_list);
+    struct Free_Node** tail = &self->free_list;
 
+    size_t capacity = 0;
     size_t last_idx = 0;
     while (last_idx < size)
     {
@@ -357,10 +387,15 @@ vrd_Seq_table_read(vrd_Seq_Table* const self,
             goto error;
         } // if
 
-        sequence = malloc(len);
-        if (NULL == sequence)
+        if (capacity < len)
         {
-            goto error;
+            char* const tmp = realloc(sequence, len);
+            if (NULL == tmp)
+            {
+                goto error;
+            } // if
+            sequence = tmp;
+            capacity = len;
         } // if
 
         count = fread(sequence, 1, len, stream);
@@ -383,50 +418,56 @@ vrd_Seq_table_read(vrd_Seq_Table* const self,
             goto error;
         } // if
 
-        if (last_idx != idx)
+        if (idx < last_idx || idx >= size || 0 == ref_count)
         {
-            for (size_t i = last_idx; i < idx; ++i)
-            {
-                self->free_list = free_list_dealloc(self->free_list, i);
-            } // for
+            errno = -1;
+            goto error;
         } // if
 
-        for (size_t i = 0; i < ref_count; ++i)
+        if (last_idx != idx)
         {
-            vrd_Trie_Node* const elem = vrd_trie_insert(self->trie, len, sequence, (void*) idx);
-            if (NULL == elem)
+            *tail = free_node_init(last_idx, idx, NULL);
+            if (NULL == *tail)
             {
-                errno = -1;
                 goto error;
             } // if
+            tail = &(*tail)->next;
 
-            self->sequences[idx] = elem;
-        } // for
+            for (size_t i = last_idx; i < idx; ++i)
+            {
+                self->sequences[i] = NULL;
+            } // for
+        } // if
 
-        free(sequence);
-        sequence = NULL;
+        // a single insert with the stored reference count
+        vrd_Trie_Node* const elem = vrd_trie_insert(self->trie, len, sequence, (void*) idx);
+        if (NULL == elem)
+        {
+            errno = -1;
+            goto error;
+        } // if
+        elem->count += ref_count - 1;
+
+        self->sequences[idx] = elem;
 
         last_idx = idx + 1;
     } // while
 
-    if (NULL == self->free_list)
-    {
-        self->free_list = free_node_init(last_idx, self->capacity, NULL);
-    } // if
-    else
+    free(sequence);
+    sequence = NULL;
+
+    if (last_idx < self->capacity)
     {
-        struct Free_Node* tmp = self->free_list;
-        while (NULL != tmp->next)
+        *tail = free_node_init(last_idx, self->capacity, NULL);
+        if (NULL == *tail)
         {
-            tmp = tmp->next;
-        } // while
-
-        tmp->next = free_node_init(last_idx, self->capacity, NULL);
-    } // else
+            goto error;
+        } // if
 
-    if (0 != fclose(stream))
-    {
-        return errno;
+        for (size_t i = last_idx; i < self->capacity; ++i)
+        {
+            self->sequences[i] = NULL;
+        } // for
     } // if
 
     return 0;
@@ -434,31 +475,21 @@ vrd_Seq_table_read(vrd_Seq_Table* const self,
 error:
     {
         int const err = errno;
-        if (NULL != stream)
-        {
-            (void) fclose(stream);
-        } // if
         free(sequence);
 
         return err;
     }
-} // vrd_Seq_table_read
+} // vrd_Seq_table_load
 
 
 int
-vrd_Seq_table_write(vrd_Seq_Table const* const self,
-                    char const* const path)
+vrd_Seq_table_save(vrd_Seq_Table const* const self,
+                   vrd_Checkpoint* const checkpoint)
 {
     assert(NULL != self);
+    assert(NULL != checkpoint);
 
-    char filename[FILENAME_MAX] = {'\0'};
-    size_t const buf_size = FILENAME_MAX;
-    if (0 >= snprintf(filename, buf_size, "%s.idx", path))
-    {
-        return errno;
-    } // if
-
-    FILE* stream = fopen(filename, "wb");
+    FILE* const stream = vrd_checkpoint_begin(checkpoint, "Seq", VRD_CHECKPOINT_INDEX, VRD_ENCODING_RAW);
     if (NULL == stream)
     {
         return errno;
@@ -508,7 +539,7 @@ vrd_Seq_table_write(vrd_Seq_Table const* const self,
         } // if
     } // for
 
-    if (0 != fclose(stream))
+    if (0 != vrd_checkpoint_end(checkpoint))
     {
         return errno;
     } // if
@@ -518,14 +549,58 @@ vrd_Seq_table_write(vrd_Seq_Table const* const self,
 error:
     {
         int const err = errno;
-        if (NULL != stream)
-        {
-            (void) fclose(stream);
-        } // if
         free(sequence);
 
         return err;
     }
+} // vrd_Seq_table_save
+
+
+int
+vrd_Seq_table_read(vrd_Seq_Table* const self,
+                   char const* const path)
+{
+    assert(NULL != self);
+    assert(NULL != path);
+
+    vrd_Checkpoint* checkpoint = vrd_checkpoint_open(path, VRD_CHECKPOINT_READ);
+    if (NULL == checkpoint)
+    {
+        return errno;
+    } // if
+
+    int const err = vrd_Seq_table_load(self, checkpoint);
+    if (0 != err)
+    {
+        (void) vrd_checkpoint_close(&checkpoint);
+        return err;
+    } // if
+
+    return vrd_checkpoint_close(&checkpoint);
+} // vrd_Seq_table_read
+
+
+int
+vrd_Seq_table_write(vrd_Seq_Table const* const self,
+                    char const* const path)
+{
+    assert(NULL != self);
+    assert(NULL != path);
+
+    vrd_Checkpoint* checkpoint = vrd_checkpoint_open(path, VRD_CHECKPOINT_WRITE);
+    if (NULL == checkpoint)
+    {
+        return errno;
+    } // if
+
+    int const err = vrd_Seq_table_save(self, checkpoint);
+    if (0 != err)
+    {
+        vrd_checkpoint_abort(&checkpoint);
+        return err;
+    } // if
+
+    return vrd_checkpoint_close(&checkpoint);
 } // vrd_Seq_table_write
 
 
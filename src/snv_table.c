@@ -58,6 +58,62 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query)(VRD_TEMPLATE(VRD_TYPENAME, _Table) cons
 } // vrd_SNV_table_query
 
 
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                               size_t const len,
+                                               char const reference[len],
+                                               size_t const n,
+                                               size_t const position[n],
+                                               size_t const inserted[n],
+                                               bool const homozygous,
+                                               vrd_AVL_Tree const* const subset,
+                                               size_t result[n])
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = -1;
+        } // for
+        return -1;
+    } // if
+
+    VRD_TEMPLATE(VRD_TYPENAME, _tree_query_batch)(elem->data, n, position, inserted, homozygous, subset, result);
+    return 0;
+} // vrd_SNV_table_query_batch
+
+
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                size_t const len,
+                                                char const reference[len],
+                                                size_t const n,
+                                                size_t const position[n],
+                                                size_t const inserted[n],
+                                                bool const homozygous,
+                                                vrd_AVL_Tree const* const subset,
+                                                size_t result[n])
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = -1;
+        } // for
+        return -1;
+    } // if
+
+    VRD_TEMPLATE(VRD_TYPENAME, _tree_query_sorted)(elem->data, n, position, inserted, homozygous, subset, result);
+    return 0;
+} // vrd_SNV_table_query_sorted
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                                 size_t const len_ref,
@@ -80,6 +136,27 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tabl
 } // vrd_SNV_table_query_region
 
 
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_region_count)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                      size_t const len,
+                                                      char const reference[len],
+                                                      size_t const start,
+                                                      size_t const end,
+                                                      bool const homozygous,
+                                                      vrd_AVL_Tree const* const subset)
+{
+    assert(NULL != self);
+
+    vrd_Trie_Node* const elem = vrd_trie_find(self->trie, len, reference);
+    if (NULL == elem)
+    {
+        return -1;
+    } // if
+
+    return VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region_count)(elem->data, start, end, homozygous, subset);
+} // vrd_SNV_table_query_region_count
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _table_export)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                           FILE* stream)
@@ -3,22 +3,31 @@
 #include <stdbool.h>    // bool
 #include <stdint.h>     // int32_t, uint32_t
 #include <stdio.h>      // FILE, fprintf
+#include <string.h>     // memcpy
 
 #include "../include/avl_tree.h"    // vrd_AVL_Tree
-#include "../include/constants.h"   // VRD_HOMOZYGOUS
+#include "../include/constants.h"   // VRD_HOMOZYGOUS, VRD_MAX_*
 #include "../include/iupac.h"       // vrd_idx_to_iupac
 #include "../include/template.h"    // VRD_TEMPLATE
+#include "imath.h"      // umin
 #include "snv_tree.h"   // vrd_SNV_Tree, vrd_SNV_tree_*
-#include "tree.h"       // NULLPTR, LEFT, RIGHT
+#include "tree.h"       // NULLPTR, LEFT, RIGHT, VRD_*_SIZE
 
 
 #define VRD_TYPENAME SNV
 
 
+// Built with VRD_SUBTREE_SUMS (`make OPTIONS=VRD_SUBTREE_SUMS`), the nodes
+// keep the allele counts of their subtrees, such that the allele count of
+// a variant or a region takes O(log n) time (see:
+// vrd_*_tree_query_region_count)
+#ifdef VRD_SUBTREE_SUMS
+#define VRD_SUM
+#endif
+
+
 struct VRD_TEMPLATE(VRD_TYPENAME, _Node)
 {
-    uint32_t child[2];
-
     uint32_t key       : 28;    // position
     uint32_t count     :  4;
 
@@ -27,10 +36,121 @@ struct VRD_TEMPLATE(VRD_TYPENAME, _Node)
 
     uint32_t phase     : 28;
     uint32_t inserted  :  4;    // [0, ..., 15]
+
+#ifdef VRD_SUM
+    uint32_t sum;               // the allele count of the subtree
+    uint32_t sum_homozygous;    // idem, of the homozygous nodes
+#endif
+
+    uint32_t child[2];
 }; // vrd_SNV_Node
 
 
+// A node of a frozen tree (see: vrd_SNV_tree_freeze): a node without its
+// child pointers. The layouts agree up to there, such that query results
+// of either tree can be unpacked alike.
+struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)
+{
+    uint32_t key       : 28;    // position
+    uint32_t count     :  4;
+
+    int32_t  balance   :  3;    // unused
+    uint32_t sample_id : 29;
+
+    uint32_t phase     : 28;
+    uint32_t inserted  :  4;    // [0, ..., 15]
+}; // vrd_SNV_Frozen
+
+
+static inline void
+node_freeze(struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen)* const frozen,
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node)
+{
+    frozen->key = node->key;
+    frozen->count = node->count;
+    frozen->balance = 0;
+    frozen->sample_id = node->sample_id;
+    frozen->phase = node->phase;
+    frozen->inserted = node->inserted;
+} // node_freeze
+
+
+// The nodes of a frozen tree with equal keys are grouped by variant
+#define VRD_VARIANT
+
+
+static inline int
+variant_compare(struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) const* const lhs,
+                struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) const* const rhs)
+{
+    if (lhs->key != rhs->key)
+    {
+        return lhs->key < rhs->key ? -1 : 1;
+    } // if
+    return (lhs->inserted > rhs->inserted) - (lhs->inserted < rhs->inserted);
+} // variant_compare
+
+
+// Compares the variant of a node to the one at `position`
+static inline int
+node_variant(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node,
+             size_t const position,
+             size_t const inserted)
+{
+    if (node->key != position)
+    {
+        return node->key < position ? -1 : 1;
+    } // if
+    return (node->inserted > inserted) - (node->inserted < inserted);
+} // node_variant
+
+
+// The nodes of a tree are ordered as those of a frozen tree: the
+// carriers of a variant are consecutive in key order
+static inline int
+node_compare(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const lhs,
+             struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const rhs)
+{
+    int const cmp = node_variant(lhs, rhs->key, rhs->inserted);
+    if (0 != cmp)
+    {
+        return cmp;
+    } // if
+    return (lhs->sample_id > rhs->sample_id) - (lhs->sample_id < rhs->sample_id);
+} // node_compare
+
+
+// the fields of a packed node: key, count, sample_id, phase, inserted
+#define VRD_FIELDS 5
+
+
+static inline void
+node_pack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node,
+          uint32_t field[VRD_FIELDS])
+{
+    field[0] = node->key;
+    field[1] = node->count;
+    field[2] = node->sample_id;
+    field[3] = node->phase;
+    field[4] = node->inserted;
+} // node_pack
+
+
+static inline void
+node_unpack(struct VRD_TEMPLATE(VRD_TYPENAME, _Node)* const node,
+            uint32_t const field[VRD_FIELDS])
+{
+    node->key = field[0];
+    node->count = field[1];
+    node->sample_id = field[2];
+    node->phase = field[3];
+    node->inserted = field[4];
+} // node_unpack
+
+
 #include "template_tree.inc"    // vrd_SNV_tree_*
+#undef VRD_FIELDS
+#undef VRD_VARIANT
 
 
 void
@@ -41,12 +161,14 @@ VRD_TEMPLATE(VRD_TYPENAME, _unpack)(void* const ptr,
                                     size_t* const phase,
                                     char* const inserted)
 {
-    struct vrd_SNV_Node const* const node = ptr;
-    *position = node->key;
-    *count = node->count;
-    *sample_id = node->sample_id;
-    *phase = node->phase == VRD_HOMOZYGOUS ? (size_t) -1 : node->phase;
-    *inserted = vrd_idx_to_iupac(node->inserted);
+    // a node or a frozen node
+    struct vrd_SNV_Frozen node;
+    memcpy(&node, ptr, sizeof(node));
+    *position = node.key;
+    *count = node.count;
+    *sample_id = node.sample_id;
+    *phase = node.phase == VRD_HOMOZYGOUS ? (size_t) -1 : node.phase;
+    *inserted = vrd_idx_to_iupac(node.inserted);
 } // vrd_SNV_unpack
 
 
@@ -60,7 +182,8 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 {
     assert(NULL != self);
 
-    if (UINT32_MAX == self->next || self->capacity < self->next)
+    if (UINT32_MAX == self->next ||
+        (self->capacity < self->next && 0 != grow(self)))
     {
         return -1;
     } // if
@@ -83,41 +206,121 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_insert)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
 } // vrd_SNV_tree_insert
 
 
+// The carriers of a variant are a contiguous range of the tree
 static size_t
 query(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
-      size_t const root,
+      uint32_t const root,
       size_t const position,
       size_t const inserted,
       bool const homozygous,
       vrd_AVL_Tree const* const subset)
 {
-    if (NULLPTR == root)
-    {
-        return 0;
-    } // if
+    uint32_t stack[VRD_STACK_SIZE] = {root};
+    size_t top = NULLPTR != root;
 
-    if (self->nodes[root].key > position)
+    size_t res = 0;
+    while (0 < top)
     {
-        return query(self, self->nodes[root].child[LEFT], position, inserted, homozygous, subset);
-    } // if
+        top -= 1;
+        uint32_t ptr = stack[top];
+        while (NULLPTR != ptr)
+        {
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[ptr];
+            // TODO: IUPAC match on inserted
+            int const cmp = node_variant(node, position, inserted);
+            if (0 != cmp)
+            {
+                ptr = node->child[0 > cmp];
+                continue;
+            } // if
+
+            if ((!homozygous || node->phase == VRD_HOMOZYGOUS) &&
+                selected(self, subset, node->sample_id))
+            {
+                res += node->count;
+            } // if
+
+            // the range continues on both sides
+            if (NULLPTR != node->child[RIGHT])
+            {
+                stack[top] = node->child[RIGHT];
+                top += 1;
+            } // if
+            ptr = node->child[LEFT];
+        } // while
+    } // while
+    return res;
+} // query
 
-    if (self->nodes[root].key < position)
-    {
-        return query(self, self->nodes[root].child[RIGHT], position, inserted, homozygous, subset);
-    } // if
 
+#ifdef VRD_SUM
+// The allele count of the nodes before the variant (or up to and
+// including it)
+static uint32_t
+sum_variant(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+            size_t const position,
+            size_t const inserted,
+            bool const inclusive,
+            bool const homozygous)
+{
+    uint32_t sum = 0;
+    uint32_t tmp = self->root;
+    while (NULLPTR != tmp)
+    {
+        int const cmp = node_variant(&self->nodes[tmp], position, inserted);
+        if (0 > cmp || (inclusive && 0 == cmp))
+        {
+            sum += subtree_sum(self, self->nodes[tmp].child[LEFT], homozygous) +
+                   node_sum(self, tmp, homozygous);
+            tmp = self->nodes[tmp].child[RIGHT];
+        } // if
+        else
+        {
+            tmp = self->nodes[tmp].child[LEFT];
+        } // else
+    } // while
+    return sum;
+} // sum_variant
+#endif
+
+
+// Visits the distinct variants at the position, the carriers of a
+// variant only for a subset or with retracted samples
+static size_t
+query_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+             size_t const position,
+             size_t const inserted,
+             bool const homozygous,
+             vrd_AVL_Tree const* const subset)
+{
     size_t res = 0;
-    // TODO: IUPAC match on inserted
-    if (inserted == self->nodes[root].inserted &&
-        (!homozygous || (homozygous && self->nodes[root].phase == VRD_HOMOZYGOUS)) &&
-        (NULL == subset || vrd_AVL_tree_is_element(subset, self->nodes[root].sample_id)))
+    for (size_t i = frozen_variant(self, frozen_lower_bound(self, position));
+         i < self->variant_count && self->frozen[self->variants[i].first].key == position;
+         ++i)
     {
-        res = self->nodes[root].count;
-    } // if
-
-    return res + query(self, self->nodes[root].child[LEFT], position, inserted, homozygous, subset) +
-                 query(self, self->nodes[root].child[RIGHT], position, inserted, homozygous, subset);
-} // query
+        struct Variant const* const variant = &self->variants[i];
+        if (inserted != self->frozen[variant->first].inserted)
+        {
+            continue;
+        } // if
+
+        if (NULL == subset && NULL == self->retracted)
+        {
+            res += homozygous ? variant->homozygous : variant->count;
+            continue;
+        } // if
+
+        for (size_t j = variant->first; j < variant->first + variant->carriers; ++j)
+        {
+            if ((!homozygous || (homozygous && self->frozen[j].phase == VRD_HOMOZYGOUS)) &&
+                selected(self, subset, self->frozen[j].sample_id))
+            {
+                res += self->frozen[j].count;
+            } // if
+        } // for
+    } // for
+    return res;
+} // query_frozen
 
 
 size_t
@@ -129,45 +332,178 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const*
 {
     assert(NULL != self);
 
+    VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const tree = current(self);
+    if (NULL != tree->frozen)
+    {
+        return query_frozen(tree, position, inserted, homozygous, subset);
+    } // if
+
+#ifdef VRD_SUM
+    if (NULL == subset && NULL == self->retracted && sums_exact(self))
+    {
+        return (uint32_t) (sum_variant(self, position, inserted, true, homozygous) -
+                           sum_variant(self, position, inserted, false, homozygous));
+    } // if
+#endif
+
     return query(self, self->root, position, inserted, homozygous, subset);
 } // vrd_SNV_tree_query
 
 
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_batch)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                              size_t const n,
+                                              size_t const position[n],
+                                              size_t const inserted[n],
+                                              bool const homozygous,
+                                              vrd_AVL_Tree const* const subset,
+                                              size_t result[n])
+{
+    assert(NULL != self);
+
+    // the descents interleave on the subtree sums, the range walks of a
+    // subset do not
+#ifdef VRD_SUM
+    if (NULL != current(self)->frozen || NULL != subset || NULL != self->retracted ||
+        !sums_exact(self))
+#endif
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            result[i] = VRD_TEMPLATE(VRD_TYPENAME, _tree_query)(self, position[i], inserted[i], homozygous, subset);
+        } // for
+        return;
+    } // if
+
+#ifdef VRD_SUM
+    // the carriers of a variant are between its first and its last
+    // possible sample
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Node) first[VRD_BATCH_SIZE];
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Node) last[VRD_BATCH_SIZE];
+    uint32_t before[VRD_BATCH_SIZE];
+    uint32_t upto[VRD_BATCH_SIZE];
+    for (size_t i = 0; i < n; i += VRD_BATCH_SIZE)
+    {
+        size_t const count = umin(VRD_BATCH_SIZE, n - i);
+        for (size_t j = 0; j < count; ++j)
+        {
+            first[j].key = last[j].key = position[i + j];
+            first[j].inserted = last[j].inserted = inserted[i + j];
+            first[j].sample_id = 0;
+            last[j].sample_id = VRD_MAX_SAMPLE_ID;
+        } // for
+
+        sum_before_batch(self, count, first, false, homozygous, before);
+        sum_before_batch(self, count, last, true, homozygous, upto);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            // variants that do not fit a node are not in the tree
+            result[i + j] = VRD_MAX_POSITION < position[i + j] || 0xf < inserted[i + j] ?
+                                0 : (uint32_t) (upto[j] - before[j]);
+        } // for
+    } // for
+#endif
+} // vrd_SNV_tree_query_batch
+
+
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_sorted)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                               size_t const n,
+                                               size_t const position[n],
+                                               size_t const inserted[n],
+                                               bool const homozygous,
+                                               vrd_AVL_Tree const* const subset,
+                                               size_t result[n])
+{
+    assert(NULL != self);
+
+    struct Cursor cursor;
+    cursor_init(&cursor, self);
+
+    struct VRD_TEMPLATE(VRD_TYPENAME, _Frozen) probe = {0};
+    for (size_t i = 0; i < n; ++i)
+    {
+        // variants that do not fit a node are not in the tree
+        if (VRD_MAX_POSITION < position[i] || 0xf < inserted[i])
+        {
+            result[i] = 0;
+            continue;
+        } // if
+
+        probe.key = position[i];
+        probe.inserted = inserted[i];
+        result[i] = cursor_variant(&cursor, &probe, homozygous, subset);
+    } // for
+} // vrd_SNV_tree_query_sorted
+
+
+// Collects the nodes in the region in pre-order
 static size_t
 query_region(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
-             size_t const root,
+             uint32_t const root,
              size_t const start,
              size_t const end,
              vrd_AVL_Tree const* const subset,
-             size_t const next,
              size_t const len,
              void* result[len])
 {
-    if (NULLPTR == root || next >= len)
-    {
-        return next;
-    } // if
+    uint32_t stack[VRD_STACK_SIZE] = {root};
+    size_t top = NULLPTR != root;
 
-    if (self->nodes[root].key >= end)
+    size_t next = 0;
+    while (0 < top && next < len)
     {
-        return query_region(self, self->nodes[root].child[LEFT], start, end, subset, next, len, result);
-    } // if
+        top -= 1;
+        uint32_t ptr = stack[top];
+        while (NULLPTR != ptr && next < len)
+        {
+            struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[ptr];
+            if (node->key < start || node->key >= end)
+            {
+                ptr = node->child[node->key < start];
+                continue;
+            } // if
+
+            if (selected(self, subset, node->sample_id))
+            {
+                result[next] = (void*) node;
+                next += 1;
+            } // if
+
+            if (NULLPTR != node->child[RIGHT])
+            {
+                stack[top] = node->child[RIGHT];
+                top += 1;
+            } // if
+            ptr = node->child[LEFT];
+        } // while
+    } // while
+    return next;
+} // query_region
 
-    if (self->nodes[root].key < start)
-    {
-        return query_region(self, self->nodes[root].child[RIGHT], start, end, subset, next, len, result);
-    } // if
 
-    size_t match = 0;
-    if (NULL == subset || vrd_AVL_tree_is_element(subset, self->nodes[root].sample_id))
+static size_t
+query_region_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                    size_t const start,
+                    size_t const end,
+                    vrd_AVL_Tree const* const subset,
+                    size_t const len,
+                    void* result[len])
+{
+    size_t next = 0;
+    for (size_t i = frozen_lower_bound(self, start);
+         i < self->base.entries && next < len && self->frozen[i].key < end;
+         ++i)
     {
-        result[next] = (void*) &self->nodes[root];
-        match = 1;
-    } // if
-
-    size_t const count = query_region(self, self->nodes[root].child[LEFT], start, end, subset, next + match, len, result);
-    return query_region(self, self->nodes[root].child[RIGHT], start, end, subset, count, len, result);
-} // query_region
+        if (selected(self, subset, self->frozen[i].sample_id))
+        {
+            result[next] = (void*) &self->frozen[i];
+            next += 1;
+        } // if
+    } // for
+    return next;
+} // query_region_frozen
 
 
 size_t
@@ -180,7 +516,13 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_query_region)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)
 {
     assert(NULL != self);
 
-    return query_region(self, self->root, start, end, subset, 0, len, result);
+    VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const tree = current(self);
+    if (NULL != tree->frozen)
+    {
+        return query_region_frozen(tree, start, end, subset, len, result);
+    } // if
+
+    return query_region(self, self->root, start, end, subset, len, result);
 } // vrd_SNV_tree_query_region
 
 
@@ -191,20 +533,47 @@ export(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
        size_t const len,
        char const reference[len])
 {
-    if (NULLPTR == root)
-    {
-        return 0;
-    } // if
+    uint32_t stack[VRD_STACK_SIZE];
+    size_t top = 0;
 
-    size_t count = export(self, self->nodes[root].child[LEFT], stream, len, reference);
+    size_t count = 0;
+    uint32_t ptr = root;
+    while (NULLPTR != ptr || 0 < top)
+    {
+        // in key order: the left spine first
+        for (; NULLPTR != ptr; ptr = self->nodes[ptr].child[LEFT])
+        {
+            stack[top] = ptr;
+            top += 1;
+        } // for
+        top -= 1;
+        struct VRD_TEMPLATE(VRD_TYPENAME, _Node) const* const node = &self->nodes[stack[top]];
+
+        int const phase = node->phase == VRD_HOMOZYGOUS ? -1 : (int) node->phase;
+
+        (void) fprintf(stream, "%s\t%u\t%u\t%u\t%d\t1\t%c\n", reference, node->key, node->key + 1, node->count, phase, vrd_idx_to_iupac(node->inserted));
+
+        count += 1;
+        ptr = node->child[RIGHT];
+    } // while
+    return count;
+} // export
 
-    int const phase = self->nodes[root].phase == VRD_HOMOZYGOUS ? -1 : (int) self->nodes[root].phase;
 
-    (void) fprintf(stream, "%s\t%u\t%u\t%u\t%d\t1\t%c\n", reference, self->nodes[root].key, self->nodes[root].key + 1, self->nodes[root].count, phase, vrd_idx_to_iupac(self->nodes[root].inserted));
+static size_t
+export_frozen(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+              FILE* stream,
+              size_t const len,
+              char const reference[len])
+{
+    for (size_t i = 0; i < self->base.entries; ++i)
+    {
+        int const phase = self->frozen[i].phase == VRD_HOMOZYGOUS ? -1 : (int) self->frozen[i].phase;
 
-    count += export(self, self->nodes[root].child[RIGHT], stream, len, reference);
-    return count + 1;
-} // export
+        (void) fprintf(stream, "%s\t%u\t%u\t%u\t%d\t1\t%c\n", reference, self->frozen[i].key, self->frozen[i].key + 1, self->frozen[i].count, phase, vrd_idx_to_iupac(self->frozen[i].inserted));
+    } // for
+    return self->base.entries;
+} // export_frozen
 
 
 size_t
@@ -216,8 +585,14 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_export)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const
     assert(NULL != self);
     assert(NULL != stream);
 
+    if (NULL != self->frozen)
+    {
+        return export_frozen(self, stream, len, reference);
+    } // if
+
     return export(self, self->root, stream, len, reference);
 } // vrd_SNV_export
 
 
+#undef VRD_SUM
 #undef VRD_TYPENAME
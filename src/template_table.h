@@ -6,6 +6,7 @@
 
 #include <stddef.h>     // size_t
 
+#include "../include/checkpoint.h"  // vrd_Checkpoint
 #include "../include/diagnostics.h"     // vrd_Diagnostics
 #include "tree.h"   // vrd_Tree
 
@@ -27,15 +28,142 @@ VRD_TEMPLATE(VRD_TYPENAME, _table_remove)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* co
                                           vrd_AVL_Tree const* const subset);
 
 
+/**
+ * Retract a sample: it is hidden from all queries right away, but its
+ * entries are only removed by vrd_*_table_compact(), e.g., in the
+ * background or before the next checkpoint. Until then, queries
+ * without a subset lose their shortcuts (the sums and the depth) as
+ * every entry is checked. A saved table keeps its retracted samples,
+ * they are hidden again once it is loaded. The sample ID should not be
+ * reused before the compaction.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_retract)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
+                                           size_t const sample_id);
+
+
+/**
+ * Remove the entries of all retracted samples (see: vrd_*_table_remove)
+ * and forget about them. The retracted samples of a frozen table are
+ * hidden for good.
+ *
+ * @return The number of removed entries.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_compact)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
+/**
+ * Keep a list of the entries of every sample in all trees, also in the
+ * ones added or loaded later (see: vrd_*_tree_postings). Removing
+ * samples then only visits their entries and skips the trees without
+ * any; finding the entries of a sample no longer scans the trees.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_postings)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
+/**
+ * Find (at most `len_res`) entries of a sample on a reference, e.g., to
+ * export a sample.
+ *
+ * @return The number of entries, or `(size_t) -1` for an unknown
+ *         reference.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _table_query_sample)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                                size_t const len_ref,
+                                                char const reference[len_ref],
+                                                size_t const sample_id,
+                                                size_t const len_res,
+                                                void* result[len_res]);
+
+
+/**
+ * Set the room for growth of the trees loaded from a checkpoint, as a
+ * percentage of their entries (default: 0). Loaded trees are allocated
+ * to fit their entries; a tree that was still growing when it was saved
+ * keeps (at most) this much of its former capacity.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _table_set_headroom)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
+                                                size_t const headroom);
+
+
+/**
+ * Lock a table against other writers. The table functions themselves do
+ * not lock: writers that may run concurrently, e.g., with a background
+ * snapshot (see: vrd_database_snapshot), hold the lock for as long as
+ * the table is inconsistent, such as for the import of a whole sample.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _table_lock)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
+void
+VRD_TEMPLATE(VRD_TYPENAME, _table_unlock)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
 int
 VRD_TEMPLATE(VRD_TYPENAME, _table_reorder)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
 
 
+/**
+ * Make a table read-only for query-only replicas: all trees are frozen
+ * into a compact static B+-tree (see: vrd_*_tree_freeze). A frozen
+ * table cannot be modified, loaded into or saved.
+ *
+ * @return 0 on success, an errno or -1 otherwise; the table is not
+ *         frozen then, but the trees that were frozen stay so.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_freeze)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
+/**
+ * (Re)build the static indices of the trees that changed since the last
+ * call (see: vrd_*_tree_index), e.g., periodically for a table that
+ * mostly serves queries. Unlike vrd_*_table_freeze(), the table stays
+ * writable; queries on a modified tree use the tree itself until its
+ * index is rebuilt. Not during a bulk load.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_index)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
+/**
+ * Start a bulk load, e.g., of a sample: inserts are appended to the
+ * trees (see: vrd_*_tree_bulk) until vrd_*_table_merge() links them in.
+ * Until then, queries do not find them and the table cannot be saved.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _table_bulk)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_merge)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self);
+
+
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_load)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
+                                        vrd_Checkpoint* const checkpoint);
+
+
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_save)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
+                                        vrd_Checkpoint* const checkpoint);
+
+
 int
 VRD_TEMPLATE(VRD_TYPENAME, _table_read)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
                                         char const* const path);
 
 
+int
+VRD_TEMPLATE(VRD_TYPENAME, _table_map)(VRD_TEMPLATE(VRD_TYPENAME, _Table)* const self,
+                                       char const* const path);
+
+
 int
 VRD_TEMPLATE(VRD_TYPENAME, _table_write)(VRD_TEMPLATE(VRD_TYPENAME, _Table) const* const self,
                                          char const* const path);
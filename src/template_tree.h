@@ -4,6 +4,7 @@
 #endif
 
 
+#include <stdbool.h>    // bool
 #include <stddef.h>     // size_t
 #include <stdio.h>      // FILE
 
@@ -12,6 +13,10 @@ VRD_TEMPLATE(VRD_TYPENAME, _Tree)*
 VRD_TEMPLATE(VRD_TYPENAME, _tree_init)(size_t const capacity);
 
 
+VRD_TEMPLATE(VRD_TYPENAME, _Tree)*
+VRD_TEMPLATE(VRD_TYPENAME, _tree_map)(void* const addr, size_t const size);
+
+
 void
 VRD_TEMPLATE(VRD_TYPENAME, _tree_destroy)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)** const self);
 
@@ -21,19 +26,139 @@ VRD_TEMPLATE(VRD_TYPENAME, _tree_remove)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* cons
                                          vrd_AVL_Tree const* const subset);
 
 
+/**
+ * Start a bulk load: the nodes inserted from now on are appended to the
+ * tree without rebalancing. They are linked into the tree by
+ * vrd_*_tree_merge(); until then, queries do not find them.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_bulk)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self);
+
+
+/**
+ * End a bulk load: the tree and the appended nodes are merged as sorted
+ * runs and rebuilt perfectly balanced. For nodes that were inserted in
+ * key order, this takes linear time. Fewer than n / log n nodes appended
+ * to a tree of n nodes are inserted one by one instead.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _tree_merge)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self);
+
+
 int
 VRD_TEMPLATE(VRD_TYPENAME, _tree_reorder)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self);
 
 
+/**
+ * Convert a tree into a read-only static B+-tree: the nodes in key order,
+ * without child pointers and balance factors, and an index of internal
+ * nodes of one cache line each. Lookups touch one cache line per level
+ * and regions are scanned sequentially. A frozen tree can be queried,
+ * but it cannot be modified or written.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _tree_freeze)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self);
+
+
+/**
+ * Build a frozen copy of a tree (see: vrd_*_tree_freeze) next to it for
+ * read-heavy use. Queries use the copy for as long as the tree is not
+ * modified and fall back to the tree afterwards, until the copy is
+ * rebuilt by calling this again. Rebuilding an up to date copy is free.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _tree_index)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self);
+
+
+/**
+ * Hide the samples in a set from all queries on the tree, until they
+ * are removed (see: vrd_*_tree_remove). The set is not copied; `NULL`
+ * shows all samples again.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_retract)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self,
+                                          vrd_AVL_Tree const* const retracted);
+
+
+/**
+ * Keep the nodes of every sample in lists (postings) from now on, such
+ * that removing samples (see: vrd_*_tree_remove) and finding the nodes
+ * of a sample (see: vrd_*_tree_query_sample) only visit the nodes of
+ * these samples. The postings take 4 bytes per node and per sample ID;
+ * they are dropped if they cannot grow, and by freezing.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _tree_postings)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self);
+
+
+/**
+ * Find (at most `len`) nodes of a sample, in key order unless the
+ * postings are kept: these are in no particular order.
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _tree_query_sample)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                               size_t const sample_id,
+                                               size_t const len,
+                                               void* result[len]);
+
+
+/**
+ * Read a tree written by vrd_*_tree_write() from a section of @p size
+ * bytes. A node count that does not fill the section (or a tree written
+ * with another node layout) is rejected before any allocation; a short
+ * read or invalid nodes leave the tree empty.
+ */
 int
 VRD_TEMPLATE(VRD_TYPENAME, _tree_read)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self,
-                                       FILE* stream);
+                                       FILE* stream,
+                                       size_t const size);
 
 
 int
 VRD_TEMPLATE(VRD_TYPENAME, _tree_write)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
                                         FILE* stream);
 
+
+/**
+ * Read a tree written by vrd_*_tree_write_packed(). The tree is rebuilt
+ * perfectly balanced in linear time. A node count that cannot fit in
+ * the @p size bytes of the section is rejected before any allocation.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _tree_read_packed)(VRD_TEMPLATE(VRD_TYPENAME, _Tree)* const self,
+                                              FILE* stream,
+                                              size_t const size);
+
+
+/**
+ * Write the nodes in key order without child pointers: positions are
+ * delta encoded and the remaining fields are written as varints only
+ * when they differ from the previous node.
+ */
+int
+VRD_TEMPLATE(VRD_TYPENAME, _tree_write_packed)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                               FILE* stream);
+
+
+/**
+ * The exact number of bytes written by vrd_*_tree_write() or (`packed`)
+ * vrd_*_tree_write_packed().
+ */
+size_t
+VRD_TEMPLATE(VRD_TYPENAME, _tree_write_size)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                             bool const packed);
+
+
+/**
+ * The number of nodes a tree holds (including removed entries that are
+ * not yet reclaimed) and the number of nodes it has room for.
+ */
+void
+VRD_TEMPLATE(VRD_TYPENAME, _tree_size)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
+                                       size_t* const nodes,
+                                       size_t* const capacity);
+
+
 size_t
 VRD_TEMPLATE(VRD_TYPENAME, _tree_sample_count)(VRD_TEMPLATE(VRD_TYPENAME, _Tree) const* const self,
                                                size_t count[]);
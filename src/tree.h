@@ -7,7 +7,7 @@ extern "C"
 #endif
 
 
-#include <stdint.h>     // uint32_t
+#include <stdint.h>     // uint32_t, uint64_t
 
 
 static uint32_t const NULLPTR = 0;
@@ -15,12 +15,21 @@ static uint32_t const NULLPTR = 0;
 static unsigned int const LEFT = 0;
 static unsigned int const RIGHT = 1;
 
+// The trees are at most 64 levels high (see: insert), an iterative
+// traversal keeps at most one node per level on its stack
+#define VRD_STACK_SIZE 64
+
+// The number of descents of a batched query that advance in lockstep
+// (see: vrd_*_tree_query_batch)
+#define VRD_BATCH_SIZE 16
+
 
 typedef struct vrd_Tree
 {
     uint32_t entries;
     uint32_t entry_size;
     uint32_t height;
+    uint64_t generation;    // changes on every insert and remove
 } vrd_Tree;
 
 
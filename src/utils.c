@@ -1,10 +1,17 @@
 #include <assert.h>     // assert
+#include <errno.h>      // EINTR, errno
 #include <stddef.h>     // NULL, size_t
-#include <stdbool.h>    // false
+#include <stdbool.h>    // bool, false, true
 #include <stdio.h>      // FILE, fprintf, fscanf
-#include <string.h>     // strlen
+#include <stdlib.h>     // free, malloc
+#include <string.h>     // strcmp, strcpy, strlen
+#include <sys/types.h>  // pid_t
+#include <sys/wait.h>   // WEXITSTATUS, WIFEXITED, waitpid
+#include <unistd.h>     // _exit, fork
 
 #include "../include/avl_tree.h"    // vrd_AVL_Tree, vrd_AVL_tree_*
+#include "../include/checkpoint.h"  // VRD_CHECKPOINT_*, vrd_Checkpoint,
+                                    // vrd_checkpoint_*
 #include "../include/constants.h"   // VRD_HOMOZYGOUS
 #include "../include/cov_table.h"   // vrd_Cov_Table, vrd_Cov_table_*
 #include "../include/iupac.h"       // vrd_iupac_to_idx
@@ -12,61 +19,105 @@
 #include "../include/seq_table.h"   // vrd_Seq_Table, vrd_Seq_table_*
 #include "../include/snv_table.h"   // vrd_SNV_Table, vrd_SNV_table_*
 #include "../include/trie.h"        // vrd_Trie_Node
+#include "../include/wal.h"         // VRD_WAL_*, vrd_WAL, vrd_wal_*
 #include "../include/utils.h"       // vrd_coverage_from_file,
                                     // vrd_variants_from_file,
-                                    // vrd_annotate_from_file
+                                    // vrd_database_*, vrd_snapshot_wait,
+                                    // vrd_annotate_from_file,
+                                    // vrd_annotate_sorted_from_file
 
 
-size_t
-vrd_coverage_from_file(FILE* stream,
-                       vrd_Cov_Table* const cov,
-                       size_t const sample_id)
+static size_t
+coverage_from_file(FILE* stream,
+                   vrd_Cov_Table* const cov,
+                   size_t const sample_id,
+                   vrd_WAL* const wal)
 {
-    assert(NULL != stream);
-    assert(NULL != cov);
 
     char reference[128] = {'\0'};
     size_t start = 0;
     size_t end = 0;
     size_t allele_count = 0;
 
+    // the sample is appended to the trees and linked in at the end: the
+    // trees that receive a large share of it are rebuilt by a single
+    // merge, saving the rebalancing of every insert
+    vrd_Cov_table_bulk(cov);
+
     size_t line_count = 0;
     while (4 == fscanf(stream, "%127s %zu %zu %zu", reference, &start, &end, &allele_count))  // UNSAFE
     {
-        if (0 != vrd_Cov_table_insert(cov, strlen(reference) + 1, reference, start, end, allele_count, sample_id))
+        if ((NULL != wal && 0 != vrd_wal_cov_insert(wal, strlen(reference) + 1, reference, start, end, allele_count, sample_id)) ||
+            0 != vrd_Cov_table_insert(cov, strlen(reference) + 1, reference, start, end, allele_count, sample_id))
         {
-            vrd_AVL_Tree* subset = vrd_AVL_tree_init(1);
-            if (NULL == subset)
-            {
-                return line_count;
-            } // if
-            if (0 != vrd_AVL_tree_insert(subset, sample_id))
-            {
-                return line_count;
-            } // if
-
-            line_count -= vrd_Cov_table_remove(cov, subset);
-            vrd_AVL_tree_destroy(&subset);
-            return line_count;
+            goto error;
         } // if
         line_count += 1;  // OVERFLOW
     } // while
 
+    if (0 != vrd_Cov_table_merge(cov))
+    {
+        goto error;
+    } // if
+
+    if (NULL != wal)
+    {
+        (void) vrd_wal_commit(wal);
+    } // if
     return line_count;
-} // vrd_coverage_from_file
+
+error:
+    {
+        (void) vrd_Cov_table_merge(cov);
+
+        vrd_AVL_Tree* subset = vrd_AVL_tree_init(1);
+        if (NULL == subset)
+        {
+            return line_count;
+        } // if
+        if (0 != vrd_AVL_tree_insert(subset, sample_id))
+        {
+            return line_count;
+        } // if
+
+        if (NULL != wal)
+        {
+            (void) vrd_wal_remove(wal, VRD_WAL_COV, 1, &sample_id);
+            (void) vrd_wal_commit(wal);
+        } // if
+        line_count -= vrd_Cov_table_remove(cov, subset);
+        vrd_AVL_tree_destroy(&subset);
+        return line_count;
+    }
+} // coverage_from_file
 
 
 size_t
-vrd_variants_from_file(FILE* stream,
-                       vrd_SNV_Table* const snv,
-                       vrd_MNV_Table* const mnv,
-                       vrd_Seq_Table* const seq,
-                       size_t const sample_id)
+vrd_coverage_from_file(FILE* stream,
+                       vrd_Cov_Table* const cov,
+                       size_t const sample_id,
+                       vrd_WAL* const wal)
 {
     assert(NULL != stream);
-    assert(NULL != snv);
-    assert(NULL != mnv);
-    assert(NULL != seq);
+    assert(NULL != cov);
+
+    // a sample is imported as a whole (see: vrd_database_snapshot)
+    vrd_Cov_table_lock(cov);
+    size_t const line_count = coverage_from_file(stream, cov, sample_id, wal);
+    vrd_Cov_table_unlock(cov);
+
+    return line_count;
+} // vrd_coverage_from_file
+
+
+static size_t
+variants_from_file(FILE* stream,
+                   vrd_SNV_Table* const snv,
+                   vrd_MNV_Table* const mnv,
+                   vrd_Seq_Table* const seq,
+                   size_t const sample_id,
+                   vrd_WAL* const wal)
+{
 
     char reference[128] = {'\0'};
     size_t start = 0;
@@ -76,6 +127,12 @@ vrd_variants_from_file(FILE* stream,
     size_t len = 0;
     char inserted[1024] = {'\0'};
 
+    // the sample is appended to the trees and linked in at the end: the
+    // trees that receive a large share of it are rebuilt by a single
+    // merge, saving the rebalancing of every insert
+    vrd_SNV_table_bulk(snv);
+    vrd_MNV_table_bulk(mnv);
+
     size_t line_count = 0;
     while (7 == fscanf(stream, "%127s %zu %zu %zu %zu %zu %1023s", reference, &start, &end, &allele_count, &phase, &len, inserted))  // UNSAFE
     {
@@ -91,6 +148,10 @@ vrd_variants_from_file(FILE* stream,
 
         if (1 == len && inserted[0] != '.' && 1 == end - start)
         {
+            if (NULL != wal && 0 != vrd_wal_snv_insert(wal, strlen(reference) + 1, reference, start, allele_count, sample_id, phase, vrd_iupac_to_idx(inserted[0])))
+            {
+                goto error;
+            } // if
             if (0 != vrd_SNV_table_insert(snv, strlen(reference) + 1, reference, start, allele_count, sample_id, phase, vrd_iupac_to_idx(inserted[0])))
             {
                 goto error;
@@ -103,6 +164,11 @@ vrd_variants_from_file(FILE* stream,
                 inserted[0] = '\0';
             } // if
 
+            if (NULL != wal && 0 != vrd_wal_mnv_insert(wal, strlen(reference) + 1, reference, start, end, allele_count, sample_id, phase, len + 1, inserted))
+            {
+                goto error;
+            } // if
+
             vrd_Trie_Node* const elem = vrd_Seq_table_insert(seq, len + 1, inserted);
             if (NULL == elem)
             {
@@ -118,10 +184,22 @@ vrd_variants_from_file(FILE* stream,
         line_count += 1;  // OVERFLOW
     } // while
 
+    if (0 != vrd_SNV_table_merge(snv) || 0 != vrd_MNV_table_merge(mnv))
+    {
+        goto error;
+    } // if
+
+    if (NULL != wal)
+    {
+        (void) vrd_wal_commit(wal);
+    } // if
     return line_count;
 
 error:
     {
+        (void) vrd_SNV_table_merge(snv);
+        (void) vrd_MNV_table_merge(mnv);
+
         vrd_AVL_Tree* subset = vrd_AVL_tree_init(1);
         if (NULL == subset)
         {
@@ -132,30 +210,383 @@ error:
             return line_count;
         } // if
 
+        if (NULL != wal)
+        {
+            (void) vrd_wal_remove(wal, VRD_WAL_SNV | VRD_WAL_MNV, 1, &sample_id);
+            (void) vrd_wal_commit(wal);
+        } // if
         line_count -= vrd_SNV_table_remove(snv, subset);
         line_count -= vrd_MNV_table_remove_seq(mnv, subset, seq);
         vrd_AVL_tree_destroy(&subset);
         return line_count;
     }
-} // vrd_variants_from_file
+} // variants_from_file
 
 
 size_t
-vrd_annotate_from_file(FILE* ostream,
-                       FILE* istream,
-                       vrd_Cov_Table const* const cov,
-                       vrd_SNV_Table const* const snv,
-                       vrd_MNV_Table const* const mnv,
-                       vrd_Seq_Table const* const seq,
-                       vrd_AVL_Tree const* const subset)
+vrd_variants_from_file(FILE* stream,
+                       vrd_SNV_Table* const snv,
+                       vrd_MNV_Table* const mnv,
+                       vrd_Seq_Table* const seq,
+                       size_t const sample_id,
+                       vrd_WAL* const wal)
 {
-    assert(NULL != ostream);
-    assert(NULL != istream);
+    assert(NULL != stream);
+    assert(NULL != snv);
+    assert(NULL != mnv);
+    assert(NULL != seq);
+
+    // a sample is imported as a whole (see: vrd_database_snapshot)
+    vrd_SNV_table_lock(snv);
+    vrd_MNV_table_lock(mnv);
+    vrd_Seq_table_lock(seq);
+    size_t const line_count = variants_from_file(stream, snv, mnv, seq, sample_id, wal);
+    vrd_Seq_table_unlock(seq);
+    vrd_MNV_table_unlock(mnv);
+    vrd_SNV_table_unlock(snv);
+
+    return line_count;
+} // vrd_variants_from_file
+
+
+// The tables are locked in a fixed order, the same as the imports do
+static void
+database_lock(vrd_Cov_Table* const cov,
+              vrd_SNV_Table* const snv,
+              vrd_MNV_Table* const mnv,
+              vrd_Seq_Table* const seq)
+{
+    vrd_Cov_table_lock(cov);
+    vrd_SNV_table_lock(snv);
+    vrd_MNV_table_lock(mnv);
+    vrd_Seq_table_lock(seq);
+} // database_lock
+
+
+static void
+database_unlock(vrd_Cov_Table* const cov,
+                vrd_SNV_Table* const snv,
+                vrd_MNV_Table* const mnv,
+                vrd_Seq_Table* const seq)
+{
+    vrd_Seq_table_unlock(seq);
+    vrd_MNV_table_unlock(mnv);
+    vrd_SNV_table_unlock(snv);
+    vrd_Cov_table_unlock(cov);
+} // database_unlock
+
+
+static int
+database_read(char const* const path,
+              unsigned int const flags,
+              vrd_Cov_Table* const cov,
+              vrd_SNV_Table* const snv,
+              vrd_MNV_Table* const mnv,
+              vrd_Seq_Table* const seq,
+              size_t const threads)
+{
+    assert(NULL != path);
+    assert(NULL != cov);
+    assert(NULL != snv);
+    assert(NULL != mnv);
+    assert(NULL != seq);
+
+    vrd_Checkpoint* checkpoint = vrd_checkpoint_open(path, flags);
+    if (NULL == checkpoint)
+    {
+        return errno;
+    } // if
+    vrd_checkpoint_set_threads(checkpoint, threads);
+
+    database_lock(cov, snv, mnv, seq);
+    int err = vrd_Cov_table_load(cov, checkpoint);
+    if (0 == err)
+    {
+        err = vrd_SNV_table_load(snv, checkpoint);
+    } // if
+    if (0 == err)
+    {
+        err = vrd_MNV_table_load(mnv, checkpoint);
+    } // if
+    if (0 == err)
+    {
+        err = vrd_Seq_table_load(seq, checkpoint);
+    } // if
+    database_unlock(cov, snv, mnv, seq);
+
+    int const ret = vrd_checkpoint_close(&checkpoint);
+    return 0 != err ? err : ret;
+} // database_read
+
+
+int
+vrd_database_read(char const* const path,
+                  vrd_Cov_Table* const cov,
+                  vrd_SNV_Table* const snv,
+                  vrd_MNV_Table* const mnv,
+                  vrd_Seq_Table* const seq,
+                  size_t const threads)
+{
+    return database_read(path, VRD_CHECKPOINT_READ, cov, snv, mnv, seq, threads);
+} // vrd_database_read
+
+
+int
+vrd_database_map(char const* const path,
+                 vrd_Cov_Table* const cov,
+                 vrd_SNV_Table* const snv,
+                 vrd_MNV_Table* const mnv,
+                 vrd_Seq_Table* const seq,
+                 size_t const threads)
+{
+    return database_read(path, VRD_CHECKPOINT_READ | VRD_CHECKPOINT_MAP, cov, snv, mnv, seq, threads);
+} // vrd_database_map
+
+
+int
+vrd_database_write(char const* const path,
+                   vrd_Cov_Table const* const cov,
+                   vrd_SNV_Table const* const snv,
+                   vrd_MNV_Table const* const mnv,
+                   vrd_Seq_Table const* const seq,
+                   unsigned int const flags,
+                   size_t const threads)
+{
+    assert(NULL != path);
+    assert(NULL != cov);
+    assert(NULL != snv);
+    assert(NULL != mnv);
+    assert(NULL != seq);
+
+    vrd_Checkpoint* checkpoint = vrd_checkpoint_open(path, VRD_CHECKPOINT_WRITE | flags);
+    if (NULL == checkpoint)
+    {
+        return errno;
+    } // if
+    vrd_checkpoint_set_threads(checkpoint, threads);
+
+    int err = vrd_Cov_table_save(cov, checkpoint);
+    if (0 == err)
+    {
+        err = vrd_SNV_table_save(snv, checkpoint);
+    } // if
+    if (0 == err)
+    {
+        err = vrd_MNV_table_save(mnv, checkpoint);
+    } // if
+    if (0 == err)
+    {
+        err = vrd_Seq_table_save(seq, checkpoint);
+    } // if
+
+    if (0 != err)
+    {
+        vrd_checkpoint_abort(&checkpoint);
+        return err;
+    } // if
+
+    return vrd_checkpoint_close(&checkpoint);
+} // vrd_database_write
+
+
+pid_t
+vrd_database_snapshot(char const* const path,
+                      vrd_Cov_Table* const cov,
+                      vrd_SNV_Table* const snv,
+                      vrd_MNV_Table* const mnv,
+                      vrd_Seq_Table* const seq,
+                      unsigned int const flags)
+{
+    assert(NULL != path);
     assert(NULL != cov);
     assert(NULL != snv);
     assert(NULL != mnv);
     assert(NULL != seq);
 
+    // The child writes the copy-on-write image of the tables as they are
+    // at the time of the fork; the parent continues to insert. Writers
+    // are paused for the fork only, such that no table is halfway
+    // through an update (e.g., a rotation or an import)
+    database_lock(cov, snv, mnv, seq);
+    pid_t const pid = fork();
+    if (0 != pid)
+    {
+        database_unlock(cov, snv, mnv, seq);
+        return pid;
+    } // if
+
+    // Only the forking thread exists in the child: the tables are written
+    // without workers, and the locks (held by the parent) are left alone.
+    // The exit status is the errno, or 255 for other errors
+    int const err = vrd_database_write(path, cov, snv, mnv, seq, flags, 1);
+    if (0 <= err && 255 > err)
+    {
+        _exit(err);
+    } // if
+    _exit(255);
+} // vrd_database_snapshot
+
+
+int
+vrd_snapshot_wait(pid_t const pid)
+{
+    int status = 0;
+    while (pid != waitpid(pid, &status, 0))
+    {
+        if (EINTR != errno)
+        {
+            return errno;
+        } // if
+    } // while
+
+    if (!WIFEXITED(status))
+    {
+        return -1;
+    } // if
+
+    int const err = WEXITSTATUS(status);
+    return 255 == err ? -1 : err;
+} // vrd_snapshot_wait
+
+
+// The number of lines of the same reference that are annotated at once
+// (see: vrd_*_table_query_batch)
+#define ANNOTATE_BATCH 32
+
+// The number of lines of the same reference that are annotated at once
+// in a single pass over the trees (see: vrd_*_table_query_sorted)
+#define ANNOTATE_SORTED 1024
+
+
+struct Line
+{
+    size_t start;
+    size_t end;
+    size_t len;
+    char inserted[1024];
+}; // Line
+
+
+static void
+annotate(FILE* ostream,
+         char const* const reference,
+         size_t const count,
+         struct Line line[count],
+         vrd_Cov_Table const* const cov,
+         vrd_SNV_Table const* const snv,
+         vrd_MNV_Table const* const mnv,
+         vrd_Seq_Table const* const seq,
+         vrd_AVL_Tree const* const subset,
+         bool const sorted)
+{
+    size_t const len = strlen(reference) + 1;
+
+    size_t snv_index[count];
+    size_t position[count];
+    size_t snv_inserted[count];
+    size_t snv_count = 0;
+
+    size_t mnv_index[count];
+    size_t mnv_start[count];
+    size_t mnv_end[count];
+    size_t mnv_inserted[count];
+    size_t mnv_count = 0;
+
+    size_t start[count];
+    size_t end[count];
+
+    size_t num[count];
+    for (size_t i = 0; i < count; ++i)
+    {
+        num[i] = 0;
+        start[i] = line[i].start;
+        end[i] = line[i].end;
+        if (1 == line[i].len && line[i].inserted[0] != '.' && 1 == line[i].end - line[i].start)
+        {
+            snv_index[snv_count] = i;
+            position[snv_count] = line[i].start;
+            snv_inserted[snv_count] = vrd_iupac_to_idx(line[i].inserted[0]);
+            snv_count += 1;
+            continue;
+        } // if
+
+        if (0 == line[i].len)
+        {
+            line[i].inserted[0] = '\0';
+        } // if
+
+        vrd_Trie_Node* const elem = vrd_Seq_table_query(seq, line[i].len + 1, line[i].inserted);
+        if (NULL != elem)
+        {
+            mnv_index[mnv_count] = i;
+            mnv_start[mnv_count] = line[i].start;
+            mnv_end[mnv_count] = line[i].end;
+            mnv_inserted[mnv_count] = *(size_t*) elem;
+            mnv_count += 1;
+        } // if
+    } // for
+
+    size_t res[count];
+    if (sorted)
+    {
+        (void) vrd_SNV_table_query_sorted(snv, len, reference, snv_count, position, snv_inserted, false, subset, res);
+    } // if
+    else
+    {
+        (void) vrd_SNV_table_query_batch(snv, len, reference, snv_count, position, snv_inserted, false, subset, res);
+    } // else
+    for (size_t i = 0; i < snv_count; ++i)
+    {
+        num[snv_index[i]] = res[i];
+    } // for
+
+    if (sorted)
+    {
+        (void) vrd_MNV_table_query_sorted(mnv, len, reference, mnv_count, mnv_start, mnv_end, mnv_inserted, false, subset, res);
+    } // if
+    else
+    {
+        (void) vrd_MNV_table_query_batch(mnv, len, reference, mnv_count, mnv_start, mnv_end, mnv_inserted, false, subset, res);
+    } // else
+    for (size_t i = 0; i < mnv_count; ++i)
+    {
+        num[mnv_index[i]] = res[i];
+    } // for
+
+    size_t den[count];
+    if (sorted)
+    {
+        (void) vrd_Cov_table_query_stab_sorted(cov, len, reference, count, start, end, subset, den);
+    } // if
+    else
+    {
+        (void) vrd_Cov_table_query_stab_batch(cov, len, reference, count, start, end, subset, den);
+    } // else
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        (void) fprintf(ostream, "%s\t%zu\t%zu\t%s\t%zu:%zu\n", reference, line[i].start, line[i].end, line[i].len == 0 ? "." : line[i].inserted, num[i], den[i]);  // UNCHECKED
+    } // for
+} // annotate
+
+
+// Annotates the lines of a file in chunks of up to `capacity` lines of
+// the same reference
+static size_t
+annotate_file(FILE* ostream,
+              FILE* istream,
+              vrd_Cov_Table const* const cov,
+              vrd_SNV_Table const* const snv,
+              vrd_MNV_Table const* const mnv,
+              vrd_Seq_Table const* const seq,
+              vrd_AVL_Tree const* const subset,
+              size_t const capacity,
+              struct Line line[capacity],
+              bool const sorted)
+{
+    size_t count = 0;
+    char batch[128] = {'\0'};
+
     char reference[128] = {'\0'};
     size_t start = 0;
     size_t end = 0;
@@ -172,35 +603,76 @@ vrd_annotate_from_file(FILE* ostream,
             break;
         } // if
 
-        size_t num = 0;
-        if (1 == len && inserted[0] != '.' && 1 == end - start)
+        if (capacity == count || (0 < count && 0 != strcmp(batch, reference)))
         {
-            num = vrd_SNV_table_query(snv, strlen(reference) + 1, reference, start, vrd_iupac_to_idx(inserted[0]), false, subset);
+            annotate(ostream, batch, count, line, cov, snv, mnv, seq, subset, sorted);
+            count = 0;
         } // if
-        else
-        {
-            if (0 == len)
-            {
-                inserted[0] = '\0';
-            } // if
-
-            vrd_Trie_Node* const elem = vrd_Seq_table_query(seq, len + 1, inserted);
-            if (NULL == elem)
-            {
-                num = 0;
-            } // if
-            else
-            {
-                num = vrd_MNV_table_query(mnv, strlen(reference) + 1, reference, start, end, *(size_t*) elem, false, subset);
-            } // else
-        } // else
-
-        size_t const den = vrd_Cov_table_query_stab(cov, strlen(reference) + 1, reference, start, end, subset);
 
-        (void) fprintf(ostream, "%s\t%zu\t%zu\t%s\t%zu:%zu\n", reference, start, end, len == 0 ? "." : inserted, num, den);  // UNCHECKED
+        (void) strcpy(batch, reference);
+        line[count].start = start;
+        line[count].end = end;
+        line[count].len = len;
+        (void) strcpy(line[count].inserted, inserted);
+        count += 1;
 
         line_count += 1;  // OVERFLOW
     } // while
 
+    if (0 < count)
+    {
+        annotate(ostream, batch, count, line, cov, snv, mnv, seq, subset, sorted);
+    } // if
+
     return line_count;
+} // annotate_file
+
+
+size_t
+vrd_annotate_from_file(FILE* ostream,
+                       FILE* istream,
+                       vrd_Cov_Table const* const cov,
+                       vrd_SNV_Table const* const snv,
+                       vrd_MNV_Table const* const mnv,
+                       vrd_Seq_Table const* const seq,
+                       vrd_AVL_Tree const* const subset)
+{
+    assert(NULL != ostream);
+    assert(NULL != istream);
+    assert(NULL != cov);
+    assert(NULL != snv);
+    assert(NULL != mnv);
+    assert(NULL != seq);
+
+    // the lines are annotated in batches of the same reference
+    struct Line line[ANNOTATE_BATCH];
+    return annotate_file(ostream, istream, cov, snv, mnv, seq, subset, ANNOTATE_BATCH, line, false);
 } // vrd_annotate_from_file
+
+
+size_t
+vrd_annotate_sorted_from_file(FILE* ostream,
+                              FILE* istream,
+                              vrd_Cov_Table const* const cov,
+                              vrd_SNV_Table const* const snv,
+                              vrd_MNV_Table const* const mnv,
+                              vrd_Seq_Table const* const seq,
+                              vrd_AVL_Tree const* const subset)
+{
+    assert(NULL != ostream);
+    assert(NULL != istream);
+    assert(NULL != cov);
+    assert(NULL != snv);
+    assert(NULL != mnv);
+    assert(NULL != seq);
+
+    struct Line* const line = malloc(sizeof(*line) * ANNOTATE_SORTED);
+    if (NULL == line)
+    {
+        return vrd_annotate_from_file(ostream, istream, cov, snv, mnv, seq, subset);
+    } // if
+
+    size_t const line_count = annotate_file(ostream, istream, cov, snv, mnv, seq, subset, ANNOTATE_SORTED, line, true);
+    free(line);
+    return line_count;
+} // vrd_annotate_sorted_from_file
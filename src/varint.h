@@ -0,0 +1,69 @@
+#ifndef VRD_VARINT_H
+#define VRD_VARINT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#include <stddef.h>     // size_t
+#include <stdint.h>     // uint32_t
+#include <stdio.h>      // EOF, FILE, getc, putc
+
+
+// LEB128: 7 bits per byte, the high bit marks a continuation
+static inline int
+varint_write(FILE* const stream, uint32_t value)
+{
+    while (0x80 <= value)
+    {
+        if (EOF == putc((value & 0x7f) | 0x80, stream))
+        {
+            return -1;
+        } // if
+        value >>= 7;
+    } // while
+    return EOF == putc(value, stream) ? -1 : 0;
+} // varint_write
+
+
+static inline size_t
+varint_size(uint32_t value)
+{
+    size_t size = 1;
+    while (0x80 <= value)
+    {
+        size += 1;
+        value >>= 7;
+    } // while
+    return size;
+} // varint_size
+
+
+static inline int
+varint_read(FILE* const stream, uint32_t* const value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        int const byte = getc(stream);
+        if (EOF == byte)
+        {
+            return -1;
+        } // if
+        *value |= (uint32_t) (byte & 0x7f) << shift;
+        if (0 == (byte & 0x80))
+        {
+            return 0;
+        } // if
+    } // for
+    return -1;
+} // varint_read
+
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
@@ -0,0 +1,877 @@
+#define _POSIX_C_SOURCE 200809L     // fileno, fsync, ftruncate
+
+
+#include <assert.h>     // assert
+#include <errno.h>      // ENOENT, errno
+#include <stddef.h>     // NULL, size_t
+#include <stdint.h>     // uint32_t, uint64_t, uint8_t
+#include <stdio.h>      // FILE, SEEK_SET, fclose, fflush, fopen, fread,
+                        // fseek, ftell, fwrite
+#include <stdlib.h>     // free, malloc, realloc
+#include <string.h>     // memcmp, memcpy
+#include <unistd.h>     // fsync, ftruncate
+
+#include "../include/avl_tree.h"    // vrd_AVL_Tree, vrd_AVL_tree_*
+#include "../include/checkpoint.h"  // VRD_CHECKPOINT_READ,
+                                    // vrd_checkpoint_*
+#include "../include/cov_table.h"   // vrd_Cov_Table, vrd_Cov_table_*
+#include "../include/mnv_table.h"   // vrd_MNV_Table, vrd_MNV_table_*
+#include "../include/seq_table.h"   // vrd_Seq_Table, vrd_Seq_table_*
+#include "../include/snv_table.h"   // vrd_SNV_Table, vrd_SNV_table_*
+#include "../include/trie.h"        // vrd_Trie_Node
+#include "../include/wal.h"         // VRD_WAL_*, vrd_WAL, vrd_wal_*
+
+
+static char const MAGIC[8] = "VRDWAL";
+static uint32_t const VERSION = 1;
+
+// an upper bound on the payload of a record, anything larger is garbage
+static uint32_t const MAX_RECORD = 1 << 24;
+
+
+enum
+{
+    RECORD_COV = 1,
+    RECORD_SNV = 2,
+    RECORD_MNV = 3,
+    RECORD_REMOVE = 4,
+    RECORD_RETRACT = 5,
+    RECORD_COMPACT = 6
+}; // enum
+
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t unused;
+    uint64_t serial;    // of the checkpoint the log is based on
+}; // Header
+
+
+struct Record
+{
+    uint32_t size;      // of the payload
+    uint32_t checksum;  // of the payload
+}; // Record
+
+
+struct vrd_WAL
+{
+    FILE* stream;
+
+    size_t group;
+    size_t pending; // records appended since the last commit
+
+    size_t capacity;
+    size_t size;
+    uint8_t* buffer;    // the payload of the record being appended
+}; // vrd_WAL
+
+
+// FNV-1a
+static uint32_t
+checksum(size_t const size, uint8_t const data[size])
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    } // for
+    return hash;
+} // checksum
+
+
+static int
+reserve(vrd_WAL* const self, size_t const size)
+{
+    if (self->capacity >= self->size + size)
+    {
+        return 0;
+    } // if
+
+    size_t capacity = 0 < self->capacity ? self->capacity : 64;
+    while (capacity < self->size + size)
+    {
+        capacity *= 2;
+    } // while
+
+    uint8_t* const buffer = realloc(self->buffer, capacity);
+    if (NULL == buffer)
+    {
+        return errno;
+    } // if
+    self->buffer = buffer;
+    self->capacity = capacity;
+    return 0;
+} // reserve
+
+
+static int
+put_varint(vrd_WAL* const self, uint64_t value)
+{
+    int const err = reserve(self, 10);
+    if (0 != err)
+    {
+        return err;
+    } // if
+
+    while (0x80 <= value)
+    {
+        self->buffer[self->size] = (value & 0x7f) | 0x80;
+        self->size += 1;
+        value >>= 7;
+    } // while
+    self->buffer[self->size] = value;
+    self->size += 1;
+    return 0;
+} // put_varint
+
+
+static int
+put_string(vrd_WAL* const self, size_t const len, char const string[len])
+{
+    int err = put_varint(self, len);
+    if (0 != err)
+    {
+        return err;
+    } // if
+    err = reserve(self, len);
+    if (0 != err)
+    {
+        return err;
+    } // if
+
+    memcpy(self->buffer + self->size, string, len);
+    self->size += len;
+    return 0;
+} // put_string
+
+
+static int
+get_varint(size_t const size, uint8_t const data[size], size_t* const cursor, uint64_t* const value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64 && *cursor < size; shift += 7)
+    {
+        uint8_t const byte = data[*cursor];
+        *cursor += 1;
+        *value |= (uint64_t) (byte & 0x7f) << shift;
+        if (0 == (byte & 0x80))
+        {
+            return 0;
+        } // if
+    } // for
+    return -1;
+} // get_varint
+
+
+static int
+get_size(size_t const size, uint8_t const data[size], size_t* const cursor, size_t* const value)
+{
+    uint64_t tmp = 0;
+    if (0 != get_varint(size, data, cursor, &tmp) || SIZE_MAX < tmp)
+    {
+        return -1;
+    } // if
+    *value = tmp;
+    return 0;
+} // get_size
+
+
+// strings are NULL-terminated in the log, their length includes it
+static int
+get_string(size_t const size, uint8_t const data[size], size_t* const cursor, size_t* const len, char const** const string)
+{
+    if (0 != get_size(size, data, cursor, len) || 0 == *len || size - *cursor < *len ||
+        '\0' != data[*cursor + *len - 1])
+    {
+        return -1;
+    } // if
+    *string = (char const*) data + *cursor;
+    *cursor += *len;
+    return 0;
+} // get_string
+
+
+// reads a record; returns 1 at the (possibly torn) end of the log
+static int
+read_record(FILE* const stream, size_t* const capacity, uint8_t** const buffer, uint32_t* const size)
+{
+    struct Record record;
+    if (1 != fread(&record, sizeof(record), 1, stream) || MAX_RECORD < record.size)
+    {
+        return 1;
+    } // if
+
+    if (*capacity < record.size)
+    {
+        uint8_t* const tmp = realloc(*buffer, record.size);
+        if (NULL == tmp)
+        {
+            return errno;
+        } // if
+        *buffer = tmp;
+        *capacity = record.size;
+    } // if
+
+    if (record.size != fread(*buffer, 1, record.size, stream) ||
+        record.checksum != checksum(record.size, *buffer))
+    {
+        return 1;
+    } // if
+
+    *size = record.size;
+    return 0;
+} // read_record
+
+
+static int
+write_header(FILE* const stream, uint64_t const serial)
+{
+    struct Header header = {.version = VERSION, .serial = serial};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+
+    if (0 != fseek(stream, 0, SEEK_SET))
+    {
+        return errno;
+    } // if
+    if (1 != fwrite(&header, sizeof(header), 1, stream))
+    {
+        return errno;
+    } // if
+    return 0;
+} // write_header
+
+
+static int
+read_header(FILE* const stream, uint64_t* const serial)
+{
+    struct Header header;
+    if (1 != fread(&header, sizeof(header), 1, stream))
+    {
+        return -1;
+    } // if
+
+    if (0 != memcmp(header.magic, MAGIC, sizeof(MAGIC)) || VERSION != header.version)
+    {
+        return -1;
+    } // if
+
+    *serial = header.serial;
+    return 0;
+} // read_header
+
+
+static int
+checkpoint_serial(char const* const path, uint64_t* const serial)
+{
+    if (NULL == path)
+    {
+        *serial = 0;
+        return 0;
+    } // if
+
+    vrd_Checkpoint* checkpoint = vrd_checkpoint_open(path, VRD_CHECKPOINT_READ);
+    if (NULL == checkpoint)
+    {
+        return errno;
+    } // if
+    *serial = vrd_checkpoint_serial(checkpoint);
+    return vrd_checkpoint_close(&checkpoint);
+} // checkpoint_serial
+
+
+vrd_WAL*
+vrd_wal_open(char const* const path, size_t const group)
+{
+    assert(NULL != path);
+
+    vrd_WAL* const self = malloc(sizeof(*self));
+    if (NULL == self)
+    {
+        return NULL;
+    } // if
+
+    self->group = group;
+    self->pending = 0;
+    self->capacity = 0;
+    self->size = 0;
+    self->buffer = NULL;
+
+    self->stream = fopen(path, "r+b");
+    if (NULL == self->stream)
+    {
+        if (ENOENT != errno)
+        {
+            goto error;
+        } // if
+
+        self->stream = fopen(path, "w+b");
+        if (NULL == self->stream)
+        {
+            goto error;
+        } // if
+        if (0 != write_header(self->stream, 0) || 0 != vrd_wal_commit(self))
+        {
+            goto error;
+        } // if
+        return self;
+    } // if
+
+    uint64_t serial = 0;
+    if (0 != read_header(self->stream, &serial))
+    {
+        errno = -1;
+        goto error;
+    } // if
+
+    // skip the valid records and cut off a torn tail
+    long end = ftell(self->stream);
+    uint32_t size = 0;
+    int ret = 0;
+    while (0 == (ret = read_record(self->stream, &self->capacity, &self->buffer, &size)))
+    {
+        end = ftell(self->stream);
+    } // while
+    if (1 != ret)
+    {
+        errno = ret;
+        goto error;
+    } // if
+
+    if (0 > end || 0 != fflush(self->stream) ||
+        0 != ftruncate(fileno(self->stream), end) ||
+        0 != fseek(self->stream, end, SEEK_SET))
+    {
+        goto error;
+    } // if
+
+    return self;
+
+error:
+    {
+        int const err = errno;
+        if (NULL != self->stream)
+        {
+            fclose(self->stream);
+        } // if
+        free(self->buffer);
+        free(self);
+        errno = err;
+        return NULL;
+    }
+} // vrd_wal_open
+
+
+int
+vrd_wal_close(vrd_WAL** const self)
+{
+    if (NULL == self || NULL == *self)
+    {
+        return 0;
+    } // if
+
+    int err = vrd_wal_commit(*self);
+    if (0 != fclose((*self)->stream) && 0 == err)
+    {
+        err = errno;
+    } // if
+
+    free((*self)->buffer);
+    free(*self);
+    *self = NULL;
+    return err;
+} // vrd_wal_close
+
+
+int
+vrd_wal_commit(vrd_WAL* const self)
+{
+    assert(NULL != self);
+
+    if (0 != fflush(self->stream) || 0 != fsync(fileno(self->stream)))
+    {
+        return errno;
+    } // if
+
+    self->pending = 0;
+    return 0;
+} // vrd_wal_commit
+
+
+int
+vrd_wal_reset(vrd_WAL* const self, char const* const checkpoint)
+{
+    assert(NULL != self);
+
+    uint64_t serial = 0;
+    int err = checkpoint_serial(checkpoint, &serial);
+    if (0 != err)
+    {
+        return err;
+    } // if
+
+    if (0 != fflush(self->stream) || 0 != ftruncate(fileno(self->stream), 0))
+    {
+        return errno;
+    } // if
+
+    err = write_header(self->stream, serial);
+    if (0 != err)
+    {
+        return err;
+    } // if
+
+    return vrd_wal_commit(self);
+} // vrd_wal_reset
+
+
+// appends the record in the buffer
+static int
+append(vrd_WAL* const self)
+{
+    struct Record const record = {
+        .size = self->size,
+        .checksum = checksum(self->size, self->buffer)
+    };
+
+    if (1 != fwrite(&record, sizeof(record), 1, self->stream) ||
+        self->size != fwrite(self->buffer, 1, self->size, self->stream))
+    {
+        return errno;
+    } // if
+    self->size = 0;
+
+    self->pending += 1;
+    if (0 < self->group && self->pending >= self->group)
+    {
+        return vrd_wal_commit(self);
+    } // if
+    return 0;
+} // append
+
+
+int
+vrd_wal_cov_insert(vrd_WAL* const self,
+                   size_t const len,
+                   char const reference[len],
+                   size_t const start,
+                   size_t const end,
+                   size_t const count,
+                   size_t const sample_id)
+{
+    assert(NULL != self);
+
+    self->size = 0;
+    if (0 != put_varint(self, RECORD_COV) ||
+        0 != put_string(self, len, reference) ||
+        0 != put_varint(self, start) ||
+        0 != put_varint(self, end) ||
+        0 != put_varint(self, count) ||
+        0 != put_varint(self, sample_id))
+    {
+        return errno;
+    } // if
+    return append(self);
+} // vrd_wal_cov_insert
+
+
+int
+vrd_wal_snv_insert(vrd_WAL* const self,
+                   size_t const len,
+                   char const reference[len],
+                   size_t const position,
+                   size_t const count,
+                   size_t const sample_id,
+                   size_t const phase,
+                   size_t const inserted)
+{
+    assert(NULL != self);
+
+    self->size = 0;
+    if (0 != put_varint(self, RECORD_SNV) ||
+        0 != put_string(self, len, reference) ||
+        0 != put_varint(self, position) ||
+        0 != put_varint(self, count) ||
+        0 != put_varint(self, sample_id) ||
+        0 != put_varint(self, phase) ||
+        0 != put_varint(self, inserted))
+    {
+        return errno;
+    } // if
+    return append(self);
+} // vrd_wal_snv_insert
+
+
+int
+vrd_wal_mnv_insert(vrd_WAL* const self,
+                   size_t const len,
+                   char const reference[len],
+                   size_t const start,
+                   size_t const end,
+                   size_t const count,
+                   size_t const sample_id,
+                   size_t const phase,
+                   size_t const inserted_len,
+                   char const inserted[inserted_len])
+{
+    assert(NULL != self);
+
+    self->size = 0;
+    if (0 != put_varint(self, RECORD_MNV) ||
+        0 != put_string(self, len, reference) ||
+        0 != put_varint(self, start) ||
+        0 != put_varint(self, end) ||
+        0 != put_varint(self, count) ||
+        0 != put_varint(self, sample_id) ||
+        0 != put_varint(self, phase) ||
+        0 != put_string(self, inserted_len, inserted))
+    {
+        return errno;
+    } // if
+    return append(self);
+} // vrd_wal_mnv_insert
+
+
+int
+vrd_wal_remove(vrd_WAL* const self,
+               unsigned int const tables,
+               size_t const n,
+               size_t const sample_id[n])
+{
+    assert(NULL != self);
+
+    self->size = 0;
+    if (0 != put_varint(self, RECORD_REMOVE) ||
+        0 != put_varint(self, tables) ||
+        0 != put_varint(self, n))
+    {
+        return errno;
+    } // if
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (0 != put_varint(self, sample_id[i]))
+        {
+            return errno;
+        } // if
+    } // for
+    return append(self);
+} // vrd_wal_remove
+
+
+int
+vrd_wal_retract(vrd_WAL* const self,
+                unsigned int const tables,
+                size_t const sample_id)
+{
+    assert(NULL != self);
+
+    self->size = 0;
+    if (0 != put_varint(self, RECORD_RETRACT) ||
+        0 != put_varint(self, tables) ||
+        0 != put_varint(self, sample_id))
+    {
+        return errno;
+    } // if
+    return append(self);
+} // vrd_wal_retract
+
+
+int
+vrd_wal_compact(vrd_WAL* const self, unsigned int const tables)
+{
+    assert(NULL != self);
+
+    self->size = 0;
+    if (0 != put_varint(self, RECORD_COMPACT) ||
+        0 != put_varint(self, tables))
+    {
+        return errno;
+    } // if
+    return append(self);
+} // vrd_wal_compact
+
+
+static int
+replay_remove(size_t const size,
+              uint8_t const data[size],
+              size_t cursor,
+              vrd_Cov_Table* const cov,
+              vrd_SNV_Table* const snv,
+              vrd_MNV_Table* const mnv,
+              vrd_Seq_Table* const seq)
+{
+    size_t tables = 0;
+    size_t n = 0;
+    if (0 != get_size(size, data, &cursor, &tables) ||
+        0 != get_size(size, data, &cursor, &n))
+    {
+        return -1;
+    } // if
+
+    vrd_AVL_Tree* subset = vrd_AVL_tree_init(n);
+    if (NULL == subset)
+    {
+        return errno;
+    } // if
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t sample_id = 0;
+        if (0 != get_size(size, data, &cursor, &sample_id) ||
+            0 != vrd_AVL_tree_insert(subset, sample_id))
+        {
+            vrd_AVL_tree_destroy(&subset);
+            return -1;
+        } // if
+    } // for
+
+    if (0 != (tables & VRD_WAL_COV))
+    {
+        (void) vrd_Cov_table_remove(cov, subset);
+    } // if
+    if (0 != (tables & VRD_WAL_SNV))
+    {
+        (void) vrd_SNV_table_remove(snv, subset);
+    } // if
+    if (0 != (tables & VRD_WAL_MNV))
+    {
+        (void) vrd_MNV_table_remove_seq(mnv, subset, seq);
+    } // if
+
+    vrd_AVL_tree_destroy(&subset);
+    return 0;
+} // replay_remove
+
+
+static int
+replay_retract(size_t const size,
+               uint8_t const data[size],
+               size_t cursor,
+               vrd_Cov_Table* const cov,
+               vrd_SNV_Table* const snv,
+               vrd_MNV_Table* const mnv)
+{
+    size_t tables = 0;
+    size_t sample_id = 0;
+    if (0 != get_size(size, data, &cursor, &tables) ||
+        0 != get_size(size, data, &cursor, &sample_id))
+    {
+        return -1;
+    } // if
+
+    int err = 0;
+    if (0 != (tables & VRD_WAL_COV))
+    {
+        err = vrd_Cov_table_retract(cov, sample_id);
+    } // if
+    if (0 == err && 0 != (tables & VRD_WAL_SNV))
+    {
+        err = vrd_SNV_table_retract(snv, sample_id);
+    } // if
+    if (0 == err && 0 != (tables & VRD_WAL_MNV))
+    {
+        err = vrd_MNV_table_retract(mnv, sample_id);
+    } // if
+    return err;
+} // replay_retract
+
+
+static int
+replay_compact(size_t const size,
+               uint8_t const data[size],
+               size_t cursor,
+               vrd_Cov_Table* const cov,
+               vrd_SNV_Table* const snv,
+               vrd_MNV_Table* const mnv,
+               vrd_Seq_Table* const seq)
+{
+    size_t tables = 0;
+    if (0 != get_size(size, data, &cursor, &tables))
+    {
+        return -1;
+    } // if
+
+    if (0 != (tables & VRD_WAL_COV))
+    {
+        (void) vrd_Cov_table_compact(cov);
+    } // if
+    if (0 != (tables & VRD_WAL_SNV))
+    {
+        (void) vrd_SNV_table_compact(snv);
+    } // if
+    if (0 != (tables & VRD_WAL_MNV))
+    {
+        (void) vrd_MNV_table_compact_seq(mnv, seq);
+    } // if
+    return 0;
+} // replay_compact
+
+
+static int
+replay_record(size_t const size,
+              uint8_t const data[size],
+              vrd_Cov_Table* const cov,
+              vrd_SNV_Table* const snv,
+              vrd_MNV_Table* const mnv,
+              vrd_Seq_Table* const seq)
+{
+    size_t cursor = 0;
+    size_t type = 0;
+    if (0 != get_size(size, data, &cursor, &type))
+    {
+        return -1;
+    } // if
+
+    if (RECORD_REMOVE == type)
+    {
+        return replay_remove(size, data, cursor, cov, snv, mnv, seq);
+    } // if
+    if (RECORD_RETRACT == type)
+    {
+        return replay_retract(size, data, cursor, cov, snv, mnv);
+    } // if
+    if (RECORD_COMPACT == type)
+    {
+        return replay_compact(size, data, cursor, cov, snv, mnv, seq);
+    } // if
+
+    size_t len = 0;
+    char const* reference = NULL;
+    if (0 != get_string(size, data, &cursor, &len, &reference))
+    {
+        return -1;
+    } // if
+
+    size_t start = 0;
+    size_t end = 0;
+    size_t count = 0;
+    size_t sample_id = 0;
+    size_t phase = 0;
+    switch (type)
+    {
+        case RECORD_COV:
+            if (0 != get_size(size, data, &cursor, &start) ||
+                0 != get_size(size, data, &cursor, &end) ||
+                0 != get_size(size, data, &cursor, &count) ||
+                0 != get_size(size, data, &cursor, &sample_id))
+            {
+                return -1;
+            } // if
+            return vrd_Cov_table_insert(cov, len, reference, start, end, count, sample_id);
+
+        case RECORD_SNV:
+        {
+            size_t inserted = 0;
+            if (0 != get_size(size, data, &cursor, &start) ||
+                0 != get_size(size, data, &cursor, &count) ||
+                0 != get_size(size, data, &cursor, &sample_id) ||
+                0 != get_size(size, data, &cursor, &phase) ||
+                0 != get_size(size, data, &cursor, &inserted))
+            {
+                return -1;
+            } // if
+            return vrd_SNV_table_insert(snv, len, reference, start, count, sample_id, phase, inserted);
+        }
+
+        case RECORD_MNV:
+        {
+            size_t inserted_len = 0;
+            char const* inserted = NULL;
+            if (0 != get_size(size, data, &cursor, &start) ||
+                0 != get_size(size, data, &cursor, &end) ||
+                0 != get_size(size, data, &cursor, &count) ||
+                0 != get_size(size, data, &cursor, &sample_id) ||
+                0 != get_size(size, data, &cursor, &phase) ||
+                0 != get_string(size, data, &cursor, &inserted_len, &inserted))
+            {
+                return -1;
+            } // if
+
+            vrd_Trie_Node* const elem = vrd_Seq_table_insert(seq, inserted_len, inserted);
+            if (NULL == elem)
+            {
+                return -1;
+            } // if
+            return vrd_MNV_table_insert(mnv, len, reference, start, end, count, sample_id, phase, *(size_t*) elem);
+        }
+    } // switch
+
+    return -1;
+} // replay_record
+
+
+int
+vrd_wal_replay(char const* const path,
+               char const* const checkpoint,
+               vrd_Cov_Table* const cov,
+               vrd_SNV_Table* const snv,
+               vrd_MNV_Table* const mnv,
+               vrd_Seq_Table* const seq,
+               size_t* const count)
+{
+    assert(NULL != path);
+    assert(NULL != cov);
+    assert(NULL != snv);
+    assert(NULL != mnv);
+    assert(NULL != seq);
+    assert(NULL != count);
+
+    *count = 0;
+
+    uint64_t expected = 0;
+    int err = checkpoint_serial(checkpoint, &expected);
+    if (0 != err)
+    {
+        return err;
+    } // if
+
+    FILE* const stream = fopen(path, "rb");
+    if (NULL == stream)
+    {
+        return errno;
+    } // if
+
+    uint64_t serial = 0;
+    if (0 != read_header(stream, &serial))
+    {
+        fclose(stream);
+        return -1;
+    } // if
+
+    if (expected != serial)
+    {
+        fclose(stream);
+        return 0;
+    } // if
+
+    // see: vrd_database_snapshot
+    vrd_Cov_table_lock(cov);
+    vrd_SNV_table_lock(snv);
+    vrd_MNV_table_lock(mnv);
+    vrd_Seq_table_lock(seq);
+
+    size_t capacity = 0;
+    uint8_t* buffer = NULL;
+    uint32_t size = 0;
+    while (0 == (err = read_record(stream, &capacity, &buffer, &size)))
+    {
+        err = replay_record(size, buffer, cov, snv, mnv, seq);
+        if (0 != err)
+        {
+            break;
+        } // if
+        *count += 1;
+    } // while
+
+    vrd_Seq_table_unlock(seq);
+    vrd_MNV_table_unlock(mnv);
+    vrd_SNV_table_unlock(snv);
+    vrd_Cov_table_unlock(cov);
+
+    free(buffer);
+    fclose(stream);
+    return 1 == err ? 0 : err;
+} // vrd_wal_replay
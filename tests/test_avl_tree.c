@@ -21,6 +21,33 @@ main(int argc, char* argv[])
     ret = vrd_AVL_tree_insert(avl, 1);
     assert(0 == ret);
 
+    assert(vrd_AVL_tree_is_element(avl, 1));
+    assert(!vrd_AVL_tree_is_element(avl, 0));
+
+    // dense keys, sparse keys and the complement
+    for (size_t i = 0; i < 10000; i += 3)
+    {
+        assert(0 == vrd_AVL_tree_insert(avl, i));
+    } // for
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        assert(vrd_AVL_tree_is_element(avl, i) == (0 == i % 3 || 1 == i));
+    } // for
+    assert(!vrd_AVL_tree_is_element(avl, 1 << 28));
+
+    vrd_AVL_tree_complement(avl);
+    assert(!vrd_AVL_tree_is_element(avl, 3) && vrd_AVL_tree_is_element(avl, 4));
+    assert(vrd_AVL_tree_is_element(avl, 1 << 28));
+
+    assert(0 == vrd_AVL_tree_insert(avl, 1 << 28));
+    assert(!vrd_AVL_tree_is_element(avl, 1 << 28) && vrd_AVL_tree_is_element(avl, 4));
+    vrd_AVL_tree_complement(avl);
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        assert(vrd_AVL_tree_is_element(avl, i) == (0 == i % 3 || 1 == i));
+    } // for
+    assert(vrd_AVL_tree_is_element(avl, 1 << 28));
+
     vrd_AVL_tree_destroy(&avl);
     assert(NULL == avl);
 
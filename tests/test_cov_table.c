@@ -1,6 +1,7 @@
 #include <assert.h>     // assert
 #include <stddef.h>     // NULL, size_t
-#include <stdio.h>      // fprintf, stderr
+#include <stdint.h>     // uint32_t
+#include <stdio.h>      // fprintf, remove, stderr
 #include <stdlib.h>     // EXIT_*
 
 #include "../include/varda.h"   // vrd_*
@@ -18,7 +19,7 @@ main(int argc, char* argv[])
     FILE* stream = fopen("../python_ext/tests/test_diag_coverage.varda", "r");
     assert(NULL != stream);
 
-    vrd_coverage_from_file(stream, cov, 1);
+    vrd_coverage_from_file(stream, cov, 1, NULL);
 
     fclose(stream);
 
@@ -36,6 +37,164 @@ main(int argc, char* argv[])
     } // for
     free(diag);
 
+    // frozen trees answer the same queries
+    uint32_t seed = 42;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        size_t const start = seed % 10000;
+        assert(0 == vrd_Cov_table_insert(cov, 4, "chr", start, start + seed % 100 + 1, 1, i % 5));
+    } // for
+
+    // the depth answers stabs of single positions without a subset, the
+    // trees with one
+    vrd_AVL_Tree* all = vrd_AVL_tree_init(16);
+    assert(NULL != all);
+    for (size_t i = 0; i < 16; ++i)
+    {
+        assert(0 == vrd_AVL_tree_insert(all, i));
+    } // for
+    for (size_t i = 0; i < 10200; i += 7)
+    {
+        assert(vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, all) == vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, NULL));
+    } // for
+
+    // batches mix single positions with regions
+    size_t batch_start[50] = {0};
+    size_t batch_end[50] = {0};
+    size_t batch[50] = {0};
+    for (size_t i = 0; i < 50; ++i)
+    {
+        batch_start[i] = i * 203;
+        batch_end[i] = batch_start[i] + (i % 3 ? 1 : 20);
+    } // for
+    assert(0 == vrd_Cov_table_query_stab_batch(cov, 4, "chr", 50, batch_start, batch_end, NULL, batch));
+    for (size_t i = 0; i < 50; ++i)
+    {
+        assert(batch[i] == vrd_Cov_table_query_stab(cov, 4, "chr", batch_start[i], batch_end[i], NULL));
+    } // for
+    assert(-1 == vrd_Cov_table_query_stab_batch(cov, 4, "chX", 50, batch_start, batch_end, NULL, batch));
+    assert((size_t) -1 == batch[49]);
+
+    // a sweep answers regions in order of start, and starts anew for
+    // regions out of order
+    for (size_t i = 0; i < 50; ++i)
+    {
+        batch_start[i] = i < 40 ? i * 13 : 1000 - i;
+        batch_end[i] = batch_start[i] + (i % 3 ? 1 : 20);
+    } // for
+    assert(0 == vrd_Cov_table_query_stab_sorted(cov, 4, "chr", 50, batch_start, batch_end, NULL, batch));
+    for (size_t i = 0; i < 50; ++i)
+    {
+        assert(batch[i] == vrd_Cov_table_query_stab(cov, 4, "chr", batch_start[i], batch_end[i], NULL));
+    } // for
+    assert(0 == vrd_Cov_table_query_stab_sorted(cov, 4, "chr", 50, batch_start, batch_end, all, batch));
+    for (size_t i = 0; i < 50; ++i)
+    {
+        assert(batch[i] == vrd_Cov_table_query_stab(cov, 4, "chr", batch_start[i], batch_end[i], all));
+    } // for
+    assert(-1 == vrd_Cov_table_query_stab_sorted(cov, 4, "chX", 50, batch_start, batch_end, NULL, batch));
+    assert((size_t) -1 == batch[49]);
+
+    assert(0 == vrd_Cov_table_write(cov, "test_cov_table"));
+    vrd_Cov_Table* restored = vrd_Cov_table_init(1000, 1 << 10);
+    assert(NULL != restored);
+    assert(0 == vrd_Cov_table_read(restored, "test_cov_table"));
+    for (size_t i = 0; i < 10200; i += 7)
+    {
+        assert(vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, NULL) == vrd_Cov_table_query_stab(restored, 4, "chr", i, i + 1, NULL));
+    } // for
+    vrd_Cov_table_destroy(&restored);
+    (void) remove("test_cov_table");
+
+    void* result[1000] = {0};
+    size_t expected[100] = {0};
+    size_t expected_region[100] = {0};
+    for (size_t i = 0; i < 100; ++i)
+    {
+        expected[i] = vrd_Cov_table_query_stab(cov, 4, "chr", i * 97, i * 97 + 10, NULL);
+        expected_region[i] = vrd_Cov_table_query_region(cov, 4, "chr", i * 97, i * 97 + 500, NULL, 1000, result);
+    } // for
+
+    // an index of a writable table answers the same queries, or the
+    // trees answer them until it is rebuilt
+    assert(0 == vrd_Cov_table_index(cov));
+    for (size_t i = 0; i < 100; ++i)
+    {
+        assert(expected[i] == vrd_Cov_table_query_stab(cov, 4, "chr", i * 97, i * 97 + 10, NULL));
+        assert(expected_region[i] == vrd_Cov_table_query_region(cov, 4, "chr", i * 97, i * 97 + 500, NULL, 1000, result));
+    } // for
+
+    assert(0 == vrd_Cov_table_insert(cov, 4, "chr", 0, 20000, 3, 9));
+    for (size_t round = 0; round < 2; ++round)
+    {
+        for (size_t i = 0; i < 100; ++i)
+        {
+            assert(expected[i] + 3 == vrd_Cov_table_query_stab(cov, 4, "chr", i * 97, i * 97 + 10, NULL));
+        } // for
+        assert(0 == vrd_Cov_table_index(cov));
+    } // for
+
+    vrd_AVL_Tree* subset = vrd_AVL_tree_init(1);
+    assert(NULL != subset);
+    assert(0 == vrd_AVL_tree_insert(subset, 9));
+    assert(1 == vrd_Cov_table_remove(cov, subset));
+    vrd_AVL_tree_destroy(&subset);
+    assert(expected[0] == vrd_Cov_table_query_stab(cov, 4, "chr", 0, 10, NULL));
+    for (size_t i = 0; i < 10200; i += 7)
+    {
+        assert(vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, all) == vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, NULL));
+    } // for
+
+    // the postings remove only the entries of the sample
+    assert(0 == vrd_Cov_table_postings(cov));
+
+    // a retracted sample is hidden until the table is compacted
+    size_t const single = vrd_Cov_table_query_stab(cov, 4, "chr", 5, 6, NULL);
+    assert(0 == vrd_Cov_table_insert(cov, 4, "chr", 0, 20000, 3, 9));
+    assert(0 == vrd_Cov_table_index(cov));
+    assert(0 == vrd_Cov_table_retract(cov, 9));
+    assert(0 == vrd_Cov_table_retract(cov, 9));
+    for (size_t i = 0; i < 100; ++i)
+    {
+        assert(expected[i] == vrd_Cov_table_query_stab(cov, 4, "chr", i * 97, i * 97 + 10, NULL));
+        assert(expected[i] == vrd_Cov_table_query_stab(cov, 4, "chr", i * 97, i * 97 + 10, all));
+        assert(expected_region[i] == vrd_Cov_table_query_region(cov, 4, "chr", i * 97, i * 97 + 500, NULL, 1000, result));
+    } // for
+    assert(single == vrd_Cov_table_query_stab(cov, 4, "chr", 5, 6, NULL));
+
+    // and once the table is saved and read again
+    assert(0 == vrd_Cov_table_write(cov, "test_cov_table"));
+    restored = vrd_Cov_table_init(1000, 1 << 10);
+    assert(NULL != restored);
+    assert(0 == vrd_Cov_table_read(restored, "test_cov_table"));
+    assert(single == vrd_Cov_table_query_stab(restored, 4, "chr", 5, 6, NULL));
+    assert(1 == vrd_Cov_table_compact(restored));
+    vrd_Cov_table_destroy(&restored);
+    (void) remove("test_cov_table");
+
+    assert(1 == vrd_Cov_table_compact(cov));
+    assert(0 == vrd_Cov_table_compact(cov));
+    for (size_t i = 0; i < 10200; i += 7)
+    {
+        assert(vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, all) == vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, NULL));
+    } // for
+    assert(expected[0] == vrd_Cov_table_query_stab(cov, 4, "chr", 0, 10, NULL));
+
+    assert(0 == vrd_Cov_table_freeze(cov));
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        assert(expected[i] == vrd_Cov_table_query_stab(cov, 4, "chr", i * 97, i * 97 + 10, NULL));
+        assert(expected_region[i] == vrd_Cov_table_query_region(cov, 4, "chr", i * 97, i * 97 + 500, NULL, 1000, result));
+    } // for
+
+    for (size_t i = 0; i < 10200; i += 7)
+    {
+        assert(vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, all) == vrd_Cov_table_query_stab(cov, 4, "chr", i, i + 1, NULL));
+    } // for
+    vrd_AVL_tree_destroy(&all);
+
     vrd_Cov_table_destroy(&cov);
     assert(NULL == cov);
 
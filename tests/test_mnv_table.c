@@ -1,6 +1,6 @@
 #include <assert.h>     // assert
 #include <stddef.h>     // NULL, size_t
-#include <stdio.h>      // FILE, fopen, fclose, fprintf, stderr
+#include <stdio.h>      // FILE, fopen, fclose, fprintf, remove, stderr
 #include <stdlib.h>     // EXIT_*
 
 #include "../include/varda.h"   // vrd_*
@@ -44,7 +44,72 @@ main(int argc, char* argv[])
         (void) fprintf(stderr, "%zu: %zu--%zu\n", i, start, end);
     } // for
 
+    vrd_Checkpoint* checkpoint = vrd_checkpoint_open("test_mnv_table", VRD_CHECKPOINT_WRITE | VRD_CHECKPOINT_PACK);
+    assert(NULL != checkpoint);
+    assert(0 == vrd_MNV_table_save(mnv, checkpoint));
+    assert(0 == vrd_checkpoint_close(&checkpoint));
 
+    vrd_MNV_Table* packed = vrd_MNV_table_init(1000, 1 << 24);
+    assert(NULL != packed);
+
+    // packed trees cannot be mapped, they are read instead
+    ret = vrd_MNV_table_map(packed, "test_mnv_table");
+    assert(0 == ret);
+
+    assert(region_count == vrd_MNV_table_query_region(packed, 5, "chr1", 0, 40, NULL, 10, result));
+    assert(1 == vrd_MNV_table_query_region(packed, 5, "chr1", 0, 7, NULL, 10, result));
+
+    vrd_MNV_table_destroy(&packed);
+    (void) remove("test_mnv_table");
+
+    // retracted samples are removed with their sequences by a compaction,
+    // the postings only visit their entries
+    assert(0 == vrd_MNV_table_postings(mnv));
+    vrd_Trie_Node* const retracted = vrd_Seq_table_insert(seq, 3, "CC");
+    assert(NULL != retracted);
+    ret = vrd_MNV_table_insert(mnv, 5, "chr1", 30, 32, 1, 3, 10, *(size_t*) retracted);
+    assert(0 == ret);
+    assert(0 == vrd_MNV_table_retract(mnv, 3));
+    assert(0 == vrd_MNV_table_query(mnv, 5, "chr1", 30, 32, *(size_t*) retracted, false, NULL));
+    assert(region_count == vrd_MNV_table_query_region(mnv, 5, "chr1", 0, 40, NULL, 10, result));
+    assert(1 == vrd_MNV_table_compact_seq(mnv, seq));
+    assert(region_count == vrd_MNV_table_query_region(mnv, 5, "chr1", 0, 40, NULL, 10, result));
+
+    // frozen trees answer the same queries, their nodes unpack alike
+    ret = vrd_MNV_table_insert(mnv, 5, "chr1", 12, 14, 2, 2, 10, *(size_t*) elem);
+    assert(0 == ret);
+    assert(3 == vrd_MNV_table_query_region_count(mnv, 5, "chr1", 10, 13, false, NULL));
+    assert(0 == vrd_MNV_table_freeze(mnv));
+
+    assert(1 == vrd_MNV_table_query(mnv, 5, "chr1", 10, 20, *(size_t*) elem, false, NULL));
+    assert(2 == vrd_MNV_table_query(mnv, 5, "chr1", 12, 14, *(size_t*) elem, false, NULL));
+    assert(2 == vrd_MNV_table_query_region(mnv, 5, "chr1", 0, 15, NULL, 10, result));
+    assert(4 == vrd_MNV_table_query_region_count(mnv, 5, "chr1", 0, 15, false, NULL));
+    assert(3 == vrd_MNV_table_query_region_count(mnv, 5, "chr1", 10, 13, false, NULL));
+    for (size_t i = 0; i < 2; ++i)
+    {
+        size_t start = 0;
+        size_t end = 0;
+        size_t allele_count = 0;
+        size_t sample_id = 0;
+        size_t phase = 0;
+        size_t inserted = 0;
+        vrd_MNV_unpack(result[i], &start, &end, &allele_count, &sample_id, &phase, &inserted);
+        assert((5 == start && 6 == end && 1 == allele_count) ||
+               (12 == start && 14 == end && 2 == allele_count && 2 == sample_id));
+    } // for
+
+    // frozen tables are read-only
+    assert(0 != vrd_MNV_table_insert(mnv, 5, "chr1", 30, 31, 1, 1, 10, *(size_t*) elem));
+    assert(0 != vrd_MNV_table_insert(mnv, 5, "chr2", 30, 31, 1, 1, 10, *(size_t*) elem));
+    assert(0 != vrd_MNV_table_write(mnv, "test_mnv_table"));
+
+    // and hide retracted samples for good
+    assert(0 == vrd_MNV_table_retract(mnv, 2));
+    assert(0 == vrd_MNV_table_query(mnv, 5, "chr1", 12, 14, *(size_t*) elem, false, NULL));
+    assert(2 == vrd_MNV_table_query_region_count(mnv, 5, "chr1", 0, 15, false, NULL));
+    assert(0 == vrd_MNV_table_compact_seq(mnv, seq));
+    assert(1 == vrd_MNV_table_query_region(mnv, 5, "chr1", 0, 15, NULL, 10, result));
 
 /*
     FILE* stream = fopen("mnv_export.varda", "w");
@@ -57,6 +122,35 @@ main(int argc, char* argv[])
     vrd_MNV_table_destroy(&mnv);
     assert(NULL == mnv);
 
+    // variants that start at the same position are told apart by their
+    // end and inserted sequence
+    vrd_MNV_Table* shared = vrd_MNV_table_init(4, 1 << 12);
+    assert(NULL != shared);
+    for (size_t i = 0; i < 300; ++i)
+    {
+        ret = vrd_MNV_table_insert(shared, 5, "chr1", 10, 12 + i % 3, 1, i, 10, i % 2);
+        assert(0 == ret);
+    } // for
+    assert(50 == vrd_MNV_table_query(shared, 5, "chr1", 10, 12, 0, false, NULL));
+    assert(50 == vrd_MNV_table_query(shared, 5, "chr1", 10, 14, 1, false, NULL));
+    assert(0 == vrd_MNV_table_query(shared, 5, "chr1", 10, 15, 0, false, NULL));
+    size_t const batch_start[3] = {10, 10, 10};
+    size_t const batch_end[3] = {12, 14, 15};
+    size_t const batch_inserted[3] = {0, 1, 0};
+    size_t batch[3] = {0};
+    assert(0 == vrd_MNV_table_query_batch(shared, 5, "chr1", 3, batch_start, batch_end, batch_inserted, false, NULL, batch));
+    assert(50 == batch[0] && 50 == batch[1] && 0 == batch[2]);
+    assert(0 == vrd_MNV_table_query_sorted(shared, 5, "chr1", 3, batch_start, batch_end, batch_inserted, false, NULL, batch));
+    assert(50 == batch[0] && 50 == batch[1] && 0 == batch[2]);
+    // a repeated variant is answered again
+    size_t const sorted_end[3] = {12, 12, 15};
+    size_t const sorted_inserted[3] = {0, 0, 0};
+    assert(0 == vrd_MNV_table_query_sorted(shared, 5, "chr1", 3, batch_start, sorted_end, sorted_inserted, false, NULL, batch));
+    assert(50 == batch[0] && 50 == batch[1] && 0 == batch[2]);
+    assert(0 == vrd_MNV_table_retract(shared, 0));
+    assert(49 == vrd_MNV_table_query(shared, 5, "chr1", 10, 12, 0, false, NULL));
+    vrd_MNV_table_destroy(&shared);
+
     vrd_Seq_table_destroy(&seq);
     assert(NULL == seq);
 
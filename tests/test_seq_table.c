@@ -1,7 +1,7 @@
 #include <assert.h>     // assert
 #include <stddef.h>     // NULL, size_t
-#include <stdio.h>      // fprintf, stderr
-#include <stdlib.h>     // EXIT_*
+#include <stdio.h>      // fprintf, remove, stderr
+#include <stdlib.h>     // EXIT_*, free
 
 #include "../include/varda.h"   // vrd_*
 
@@ -46,6 +46,51 @@ main(int argc, char* argv[])
     vrd_Trie_Node* const e = vrd_Seq_table_insert(seq, 1, "");
     assert(NULL != e);
 
+    // a round trip keeps the indices, the reference counts and the gaps
+    vrd_Trie_Node* const f = vrd_Seq_table_insert(seq, 3, "AC");
+    assert(NULL != f);
+    vrd_Trie_Node* const g = vrd_Seq_table_insert(seq, 3, "GT");
+    assert(NULL != g);
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        assert(g == vrd_Seq_table_insert(seq, 3, "GT"));
+    } // for
+    size_t const gap = (size_t) f->data;
+    assert(0 == vrd_Seq_table_remove(seq, gap));
+
+    assert(0 == vrd_Seq_table_write(seq, "test_seq_table"));
+
+    vrd_Seq_Table* copy = vrd_Seq_table_init(1000);
+    assert(NULL != copy);
+    assert(0 == vrd_Seq_table_read(copy, "test_seq_table"));
+
+    // the indices past the loaded ones are cleared
+    vrd_Seq_Table* longer = vrd_Seq_table_init(1000);
+    assert(NULL != longer);
+    char const* const keys[] = {"A", "C", "G", "T", "N"};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(*keys); ++i)
+    {
+        assert(NULL != vrd_Seq_table_insert(longer, 2, keys[i]));
+    } // for
+    assert(0 == vrd_Seq_table_read(longer, "test_seq_table"));
+    (void) remove("test_seq_table");
+    char* key = NULL;
+    assert(0 == vrd_Seq_table_key(longer, 4, &key));
+    free(key);
+    vrd_Seq_table_destroy(&longer);
+
+    vrd_Trie_Node* const h = vrd_Seq_table_query(copy, 3, "GT");
+    assert(NULL != h);
+    assert(g->data == h->data);
+    assert(1001 == h->count);
+    assert(NULL == vrd_Seq_table_query(copy, 3, "AC"));
+
+    vrd_Trie_Node* const k = vrd_Seq_table_insert(copy, 4, "TTT");
+    assert(NULL != k);
+    assert(gap == (size_t) k->data);
+
+    vrd_Seq_table_destroy(&copy);
+
     vrd_Seq_table_destroy(&seq);
     assert(NULL == seq);
 
@@ -1,7 +1,12 @@
 #include <assert.h>     // assert
+#include <stdbool.h>    // bool, false
 #include <stddef.h>     // NULL, size_t
-#include <stdio.h>      // FILE, fopen, fclose, fprintf, stderr
-#include <stdlib.h>     // EXIT_*
+#include <stdint.h>     // UINT32_MAX, uint32_t, uint64_t
+#include <stdio.h>      // FILE, SEEK_END, fclose, fopen, fprintf, fread,
+                        // fseek, ftell, fwrite, remove, rewind, stderr,
+                        // tmpfile
+#include <stdlib.h>     // EXIT_*, free, malloc
+#include <string.h>     // memcpy, memset
 
 #include "../include/varda.h"   // vrd_*
 #include "../src/snv_tree.h"    // vrd_SNV_unpack
@@ -46,6 +51,457 @@ main(int argc, char* argv[])
         (void) fprintf(stderr, "%zu: %zu\n", i, position);
     } // for
 
+    ret = vrd_SNV_table_write(snv, "test_snv_table");
+    assert(0 == ret);
+
+    vrd_SNV_Table* mapped = vrd_SNV_table_init(1000, 1 << 24);
+    assert(NULL != mapped);
+
+    ret = vrd_SNV_table_map(mapped, "test_snv_table");
+    assert(0 == ret);
+
+    assert(1 == vrd_SNV_table_query(mapped, 5, "chr1", 15, 1, false, NULL));
+    assert(2 == vrd_SNV_table_query_region(mapped, 5, "chr1", 0, 20, NULL, 10, result));
+
+    // mapped trees are read-only
+    assert(0 != vrd_SNV_table_insert(mapped, 5, "chr1", 20, 1, 2, 10, 1));
+
+    vrd_SNV_table_destroy(&mapped);
+    assert(NULL == mapped);
+
+    // a checkpoint with a section past its end is rejected before
+    // anything is mapped (the directory offset follows the header's
+    // magic, version, alignment, serial and count; the section size
+    // follows its name, id, encoding and offset)
+    FILE* stream = fopen("test_snv_table", "rb");
+    assert(NULL != stream);
+    assert(0 == fseek(stream, 0, SEEK_END));
+    long const checkpoint_size = ftell(stream);
+    assert(0 < checkpoint_size);
+    rewind(stream);
+    char* const contents = malloc(checkpoint_size);
+    assert(NULL != contents);
+    assert((size_t) checkpoint_size == fread(contents, 1, checkpoint_size, stream));
+    fclose(stream);
+    uint64_t directory = 0;
+    memcpy(&directory, contents + 32, sizeof(directory));
+    assert(directory + 32 <= (uint64_t) checkpoint_size);
+    uint64_t const section_size = checkpoint_size;
+    memcpy(contents + directory + 24, &section_size, sizeof(section_size));
+    stream = fopen("test_snv_table", "wb");
+    assert(NULL != stream);
+    assert((size_t) checkpoint_size == fwrite(contents, 1, checkpoint_size, stream));
+    fclose(stream);
+    free(contents);
+    assert(NULL == vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_READ));
+
+    (void) remove("test_snv_table");
+
+    // nothing to amend yet, the checkpoint is written from scratch
+    vrd_Checkpoint* checkpoint = vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_WRITE | VRD_CHECKPOINT_INCREMENTAL);
+    assert(NULL != checkpoint);
+    assert(0 == vrd_checkpoint_previous(checkpoint));
+    assert(0 == vrd_SNV_table_save(snv, checkpoint));
+    uint64_t const serial = vrd_checkpoint_serial(checkpoint);
+    assert(0 == vrd_checkpoint_close(&checkpoint));
+
+    ret = vrd_SNV_table_insert(snv, 5, "chr2", 30, 1, 2, 10, 1);
+    assert(0 == ret);
+
+    // only chr2 is written, chr1 is kept
+    checkpoint = vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_WRITE | VRD_CHECKPOINT_INCREMENTAL);
+    assert(NULL != checkpoint);
+    assert(serial == vrd_checkpoint_previous(checkpoint));
+    assert(0 == vrd_SNV_table_save(snv, checkpoint));
+    assert(0 == vrd_checkpoint_close(&checkpoint));
+
+    vrd_SNV_Table* amended = vrd_SNV_table_init(1000, 1 << 24);
+    assert(NULL != amended);
+
+    ret = vrd_SNV_table_read(amended, "test_snv_table");
+    assert(0 == ret);
+
+    assert(2 == vrd_SNV_table_query_region(amended, 5, "chr1", 0, 20, NULL, 10, result));
+    assert(1 == vrd_SNV_table_query(amended, 5, "chr2", 30, 1, false, NULL));
+
+    vrd_SNV_table_destroy(&amended);
+
+    // superseded sections are reclaimed by rewriting the checkpoint once
+    // they take up most of the file
+    stream = fopen("test_snv_table", "rb");
+    assert(NULL != stream);
+    assert(0 == fseek(stream, 0, SEEK_END));
+    long const amended_size = ftell(stream);
+    fclose(stream);
+    bool rewritten = false;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        ret = vrd_SNV_table_insert(snv, 5, "chr2", 31 + i, 1, 2, 10, 1);
+        assert(0 == ret);
+
+        checkpoint = vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_WRITE | VRD_CHECKPOINT_INCREMENTAL);
+        assert(NULL != checkpoint);
+        rewritten = rewritten || 0 == vrd_checkpoint_previous(checkpoint);
+        assert(0 == vrd_SNV_table_save(snv, checkpoint));
+        assert(0 == vrd_checkpoint_close(&checkpoint));
+    } // for
+    assert(rewritten);
+    stream = fopen("test_snv_table", "rb");
+    assert(NULL != stream);
+    assert(0 == fseek(stream, 0, SEEK_END));
+    assert(ftell(stream) <= 3 * amended_size);
+    fclose(stream);
+
+    amended = vrd_SNV_table_init(1000, 1 << 24);
+    assert(NULL != amended);
+    ret = vrd_SNV_table_read(amended, "test_snv_table");
+    assert(0 == ret);
+    assert(2 == vrd_SNV_table_query_region(amended, 5, "chr1", 0, 20, NULL, 10, result));
+    assert(6 == vrd_SNV_table_query_region(amended, 5, "chr2", 35, 41, NULL, 10, result));
+    vrd_SNV_table_destroy(&amended);
+    (void) remove("test_snv_table");
+
+    // the trees of the references are saved and loaded concurrently
+    char const* const references[] = {"chr3", "chr4", "chr5", "chr6", "chr7"};
+    for (size_t i = 0; i < sizeof(references) / sizeof(references[0]); ++i)
+    {
+        for (size_t j = 0; j < 100; ++j)
+        {
+            ret = vrd_SNV_table_insert(snv, 5, references[i], j * (i + 1), 1, j % 7, 10, 1);
+            assert(0 == ret);
+        } // for
+    } // for
+
+    for (unsigned int flags = 0; flags <= VRD_CHECKPOINT_PACK; flags += VRD_CHECKPOINT_PACK)
+    {
+        checkpoint = vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_WRITE | flags);
+        assert(NULL != checkpoint);
+        vrd_checkpoint_set_threads(checkpoint, 3);
+        assert(0 == vrd_SNV_table_save(snv, checkpoint));
+        assert(0 == vrd_checkpoint_close(&checkpoint));
+
+        // the trees grow to fit the loaded entries
+        vrd_SNV_Table* parallel = vrd_SNV_table_init(1000, 1);
+        assert(NULL != parallel);
+        size_t const headroom = 0 == flags ? 0 : 100;
+        vrd_SNV_table_set_headroom(parallel, headroom);
+
+        checkpoint = vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_READ);
+        assert(NULL != checkpoint);
+        vrd_checkpoint_set_threads(checkpoint, 3);
+        assert(0 == vrd_SNV_table_load(parallel, checkpoint));
+        assert(0 == vrd_checkpoint_close(&checkpoint));
+
+        assert(2 == vrd_SNV_table_query_region(parallel, 5, "chr1", 0, 20, NULL, 10, result));
+        assert(1 == vrd_SNV_table_query(parallel, 5, "chr2", 30, 1, false, NULL));
+
+        // restored trees are allocated to fit, the trees of `snv` were
+        // still growing
+        vrd_Diagnostics* diag = NULL;
+        size_t const diag_count = vrd_SNV_table_diagnostics(parallel, &diag);
+        assert(7 == diag_count);
+        for (size_t i = 0; i < diag_count; ++i)
+        {
+            assert(diag[i].entries + diag[i].entries * headroom / 100 == diag[i].capacity);
+            free(diag[i].reference);
+        } // for
+        free(diag);
+        for (size_t i = 0; i < sizeof(references) / sizeof(references[0]); ++i)
+        {
+            assert(1 == vrd_SNV_table_query(parallel, 5, references[i], 99 * (i + 1), 1, false, NULL));
+        } // for
+
+        vrd_SNV_table_destroy(&parallel);
+
+        // a failed load unlinks the references it added
+        vrd_SNV_Table* partial = vrd_SNV_table_init(1000, 1);
+        assert(NULL != partial);
+        assert(0 == vrd_SNV_table_insert(partial, 5, "chr7", 1, 1, 0, 10, 1));
+        checkpoint = vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_READ);
+        assert(NULL != checkpoint);
+        assert(0 != vrd_SNV_table_load(partial, checkpoint));
+        assert(0 == vrd_checkpoint_close(&checkpoint));
+        assert((size_t) -1 == vrd_SNV_table_query(partial, 5, "chr1", 10, 1, false, NULL));
+        assert(1 == vrd_SNV_table_query(partial, 5, "chr7", 1, 1, false, NULL));
+        diag = NULL;
+        assert(1 == vrd_SNV_table_diagnostics(partial, &diag));
+        free(diag[0].reference);
+        free(diag);
+        vrd_SNV_table_destroy(&partial);
+
+        (void) remove("test_snv_table");
+    } // for
+
+    // trees grow beyond their initial capacity
+    vrd_SNV_Table* growing = vrd_SNV_table_init(1000, 1);
+    assert(NULL != growing);
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ret = vrd_SNV_table_insert(growing, 5, "chr1", i, 1, i % 7, 10, 1);
+        assert(0 == ret);
+    } // for
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        assert(1 == vrd_SNV_table_query(growing, 5, "chr1", i, 1, false, NULL));
+    } // for
+
+    // the allele counts of regions follow from the subtree sums
+    vrd_AVL_Tree* odd = vrd_AVL_tree_init(3);
+    assert(NULL != odd);
+    assert(0 == vrd_AVL_tree_insert(odd, 1));
+    assert(0 == vrd_AVL_tree_insert(odd, 3));
+    assert(0 == vrd_AVL_tree_insert(odd, 5));
+    for (size_t i = 0; i < 1000; i += 37)
+    {
+        size_t const end = i + i % 300;
+        size_t expected_count = 0;
+        for (size_t j = i; j < end && j < 1000; ++j)
+        {
+            expected_count += 1 == (j % 7) % 2;
+        } // for
+        assert((end < 1000 ? end : 1000) - i == vrd_SNV_table_query_region_count(growing, 5, "chr1", i, end, false, NULL));
+        assert(expected_count == vrd_SNV_table_query_region_count(growing, 5, "chr1", i, end, false, odd));
+        assert(0 == vrd_SNV_table_query_region_count(growing, 5, "chr1", i, end, true, NULL));
+    } // for
+    assert((size_t) -1 == vrd_SNV_table_query_region_count(growing, 5, "chrX", 0, 1000, false, NULL));
+
+    // leave the odd samples out
+    size_t const odd_count = vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, odd);
+    vrd_AVL_tree_complement(odd);
+    assert(1000 - odd_count == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, odd));
+    assert(0 == vrd_SNV_table_query(growing, 5, "chr1", 1, 1, false, odd));
+    assert(1 == vrd_SNV_table_query(growing, 5, "chr1", 2, 1, false, odd));
+    vrd_AVL_tree_complement(odd);
+
+    // a bulk load merges (unsorted) runs into the existing tree
+    vrd_SNV_table_bulk(growing);
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ret = vrd_SNV_table_insert(growing, 5, "chr1", (i * 7919) % 1000, 1, 7, 10, 1);
+        assert(0 == ret);
+    } // for
+    assert(1 == vrd_SNV_table_query(growing, 5, "chr1", 500, 1, false, NULL));
+
+    assert(0 == vrd_SNV_table_merge(growing));
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        assert(2 == vrd_SNV_table_query(growing, 5, "chr1", i, 1, false, NULL));
+    } // for
+    assert(2000 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, NULL));
+    assert(200 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 100, 200, false, NULL));
+
+    assert(0 == vrd_SNV_table_index(growing));
+    assert(2 == vrd_SNV_table_query(growing, 5, "chr1", 500, 1, false, NULL));
+    assert(200 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 100, 200, false, NULL));
+    assert(10 == vrd_SNV_table_query_region(growing, 5, "chr1", 100, 200, NULL, 10, result));
+
+    vrd_Diagnostics* growing_diag = NULL;
+    assert(1 == vrd_SNV_table_diagnostics(growing, &growing_diag));
+    assert(2000 == growing_diag[0].entries && 11 == growing_diag[0].height);
+    free(growing_diag[0].reference);
+    free(growing_diag);
+
+    // a few nodes are linked into a large tree instead of rebuilding it
+    vrd_SNV_Table* linked = vrd_SNV_table_init(4, 1 << 12);
+    assert(NULL != linked);
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        assert(0 == vrd_SNV_table_insert(linked, 5, "chr1", i, 1, 0, 10, 1));
+    } // for
+    vrd_SNV_table_bulk(linked);
+    for (size_t i = 0; i < 5; ++i)
+    {
+        assert(0 == vrd_SNV_table_insert(linked, 5, "chr1", (i * 389) % 1000, 1, 1, 10, 1));
+    } // for
+    assert(1 == vrd_SNV_table_query(linked, 5, "chr1", 389, 1, false, NULL));
+    assert(0 == vrd_SNV_table_merge(linked));
+    for (size_t i = 0; i < 5; ++i)
+    {
+        assert(2 == vrd_SNV_table_query(linked, 5, "chr1", (i * 389) % 1000, 1, false, NULL));
+    } // for
+    assert(1005 == vrd_SNV_table_query_region_count(linked, 5, "chr1", 0, 1000, false, NULL));
+    vrd_Diagnostics* linked_diag = NULL;
+    assert(1 == vrd_SNV_table_diagnostics(linked, &linked_diag));
+    assert(1005 == linked_diag[0].entries && 11 >= linked_diag[0].height);
+    free(linked_diag[0].reference);
+    free(linked_diag);
+    vrd_SNV_table_destroy(&linked);
+
+    // the sums are restored after a removal
+    assert(3 * 143 == vrd_SNV_table_remove(growing, odd));
+    assert(2000 - 3 * 143 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, NULL));
+    assert(0 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, odd));
+    vrd_AVL_tree_destroy(&odd);
+
+    // the slots of removed nodes are reused
+    vrd_AVL_Tree* cycle = vrd_AVL_tree_init(1);
+    assert(NULL != cycle);
+    assert(0 == vrd_AVL_tree_insert(cycle, 8));
+    for (size_t i = 0; i < 10; ++i)
+    {
+        for (size_t j = 0; j < 1000; ++j)
+        {
+            ret = vrd_SNV_table_insert(growing, 5, "chr1", j, 1, 8, 10, 1);
+            assert(0 == ret);
+        } // for
+        assert(1000 == vrd_SNV_table_remove(growing, cycle));
+    } // for
+    vrd_AVL_tree_destroy(&cycle);
+
+    assert(1 == vrd_SNV_table_diagnostics(growing, &growing_diag));
+    assert(2000 - 3 * 143 == growing_diag[0].entries && 4096 >= growing_diag[0].capacity);
+    free(growing_diag[0].reference);
+    free(growing_diag);
+    assert(2000 - 3 * 143 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, NULL));
+
+    // and memory is returned once most nodes are removed
+    vrd_AVL_Tree* rest = vrd_AVL_tree_init(5);
+    assert(NULL != rest);
+    for (size_t i = 0; i < 8; i += 2)
+    {
+        assert(0 == vrd_AVL_tree_insert(rest, i));
+    } // for
+    assert(0 == vrd_AVL_tree_insert(rest, 7));
+    assert(2000 - 3 * 143 == vrd_SNV_table_remove(growing, rest));
+    vrd_AVL_tree_destroy(&rest);
+
+    assert(1 == vrd_SNV_table_diagnostics(growing, &growing_diag));
+    assert(0 == growing_diag[0].entries && 1 == growing_diag[0].capacity);
+    free(growing_diag[0].reference);
+    free(growing_diag);
+
+    ret = vrd_SNV_table_insert(growing, 5, "chr1", 500, 1, 9, 10, 1);
+    assert(0 == ret);
+    assert(1 == vrd_SNV_table_query(growing, 5, "chr1", 500, 1, false, NULL));
+
+    // retracted samples are hidden right away, also from the index, and
+    // removed by a compaction
+    for (size_t i = 0; i < 100; ++i)
+    {
+        ret = vrd_SNV_table_insert(growing, 5, "chr1", i, 1, 10, VRD_HOMOZYGOUS, 1);
+        assert(0 == ret);
+    } // for
+    assert(0 == vrd_SNV_table_index(growing));
+    assert(0 == vrd_SNV_table_retract(growing, 10));
+    assert(0 == vrd_SNV_table_query(growing, 5, "chr1", 50, 1, false, NULL));
+    assert(1 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, NULL));
+    assert(0 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, true, NULL));
+    assert(1 == vrd_SNV_table_query_region(growing, 5, "chr1", 0, 1000, NULL, 10, result));
+
+    // the retracted samples are saved with the table
+    assert(0 == vrd_SNV_table_write(growing, "test_snv_table"));
+    vrd_SNV_Table* restored = vrd_SNV_table_init(1000, 1 << 24);
+    assert(NULL != restored);
+    assert(0 == vrd_SNV_table_read(restored, "test_snv_table"));
+    assert(0 == vrd_SNV_table_query(restored, 5, "chr1", 50, 1, false, NULL));
+    assert(1 == vrd_SNV_table_query_region(restored, 5, "chr1", 0, 1000, NULL, 10, result));
+    assert(100 == vrd_SNV_table_compact(restored));
+    vrd_SNV_table_destroy(&restored);
+
+    ret = vrd_SNV_table_insert(growing, 5, "chr2", 50, 1, 10, 10, 1);
+    assert(0 == ret);
+    assert(0 == vrd_SNV_table_query(growing, 5, "chr2", 50, 1, false, NULL));
+
+    assert(101 == vrd_SNV_table_compact(growing));
+    assert(1 == vrd_SNV_table_query_region_count(growing, 5, "chr1", 0, 1000, false, NULL));
+
+    // an amended checkpoint forgets the samples compacted since
+    checkpoint = vrd_checkpoint_open("test_snv_table", VRD_CHECKPOINT_WRITE | VRD_CHECKPOINT_INCREMENTAL);
+    assert(NULL != checkpoint);
+    assert(0 != vrd_checkpoint_previous(checkpoint));
+    assert(0 == vrd_SNV_table_save(growing, checkpoint));
+    assert(0 == vrd_checkpoint_close(&checkpoint));
+    restored = vrd_SNV_table_init(1000, 1 << 24);
+    assert(NULL != restored);
+    assert(0 == vrd_SNV_table_read(restored, "test_snv_table"));
+    ret = vrd_SNV_table_insert(restored, 5, "chr1", 50, 1, 10, 10, 1);
+    assert(0 == ret);
+    assert(1 == vrd_SNV_table_query(restored, 5, "chr1", 50, 1, false, NULL));
+    assert(0 == vrd_SNV_table_compact(restored));
+    vrd_SNV_table_destroy(&restored);
+    (void) remove("test_snv_table");
+
+    vrd_SNV_table_destroy(&growing);
+
+    // frozen trees answer the same queries
+    size_t expected[5][100] = {{0}};
+    size_t expected_count[5][100] = {{0}};
+    for (size_t i = 0; i < sizeof(references) / sizeof(references[0]); ++i)
+    {
+        for (size_t j = 0; j < 100; ++j)
+        {
+            expected[i][j] = vrd_SNV_table_query_region(snv, 5, references[i], j * 3, j * 5 + 7, NULL, 10, result);
+            expected_count[i][j] = vrd_SNV_table_query_region_count(snv, 5, references[i], j * 3, j * 5 + 7, false, NULL);
+        } // for
+    } // for
+
+    // carriers of the same variants, counted per variant once frozen
+    for (size_t i = 0; i < 40; ++i)
+    {
+        ret = vrd_SNV_table_insert(snv, 5, "chr8", 50, 1 + i % 2, i % 8, i % 3 == 0 ? VRD_HOMOZYGOUS : 0, 1 + i % 4);
+        assert(0 == ret);
+    } // for
+
+    vrd_AVL_Tree* subset = vrd_AVL_tree_init(2);
+    assert(NULL != subset);
+    assert(0 == vrd_AVL_tree_insert(subset, 0));
+    assert(0 == vrd_AVL_tree_insert(subset, 2));
+
+    size_t expected_variant[4][3] = {{0}};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        expected_variant[i][0] = vrd_SNV_table_query(snv, 5, "chr8", 50, 1 + i, false, NULL);
+        expected_variant[i][1] = vrd_SNV_table_query(snv, 5, "chr8", 50, 1 + i, true, NULL);
+        expected_variant[i][2] = vrd_SNV_table_query(snv, 5, "chr8", 50, 1 + i, false, subset);
+    } // for
+
+    assert(60 == vrd_SNV_table_query_region_count(snv, 5, "chr8", 0, 100, false, NULL));
+    assert(21 == vrd_SNV_table_query_region_count(snv, 5, "chr8", 50, 51, true, NULL));
+    size_t const expected_subset = vrd_SNV_table_query_region_count(snv, 5, "chr8", 50, 51, true, subset);
+
+    assert(0 == vrd_SNV_table_freeze(snv));
+
+    assert(60 == vrd_SNV_table_query_region_count(snv, 5, "chr8", 0, 100, false, NULL));
+    assert(0 == vrd_SNV_table_query_region_count(snv, 5, "chr8", 51, 100, false, NULL));
+    assert(21 == vrd_SNV_table_query_region_count(snv, 5, "chr8", 50, 51, true, NULL));
+    assert(expected_subset == vrd_SNV_table_query_region_count(snv, 5, "chr8", 50, 51, true, subset));
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        assert(expected_variant[i][0] == vrd_SNV_table_query(snv, 5, "chr8", 50, 1 + i, false, NULL));
+        assert(expected_variant[i][1] == vrd_SNV_table_query(snv, 5, "chr8", 50, 1 + i, true, NULL));
+        assert(expected_variant[i][2] == vrd_SNV_table_query(snv, 5, "chr8", 50, 1 + i, false, subset));
+    } // for
+    assert(10 == expected_variant[0][0] && 4 == expected_variant[0][1] && 5 == expected_variant[0][2]);
+    vrd_AVL_tree_destroy(&subset);
+
+    for (size_t i = 0; i < sizeof(references) / sizeof(references[0]); ++i)
+    {
+        for (size_t j = 0; j < 100; ++j)
+        {
+            assert(1 == vrd_SNV_table_query(snv, 5, references[i], j * (i + 1), 1, false, NULL));
+            assert(expected[i][j] == vrd_SNV_table_query_region(snv, 5, references[i], j * 3, j * 5 + 7, NULL, 10, result));
+            assert(expected_count[i][j] == vrd_SNV_table_query_region_count(snv, 5, references[i], j * 3, j * 5 + 7, false, NULL));
+        } // for
+    } // for
+
+    assert(1 == vrd_SNV_table_query_region(snv, 5, "chr1", 12, 20, NULL, 10, result));
+    size_t position = 0;
+    size_t allele_count = 0;
+    size_t sample_id = 0;
+    size_t phase = 0;
+    char inserted = '\0';
+    vrd_SNV_unpack(result[0], &position, &allele_count, &sample_id, &phase, &inserted);
+    assert(15 == position && 1 == sample_id);
+
+    size_t frozen_count[10] = {0};
+    (void) vrd_SNV_table_sample_count(snv, frozen_count);
+    assert(1 + 5 * 15 + 5 == frozen_count[1]);
+
+    assert(0 != vrd_SNV_table_insert(snv, 5, "chr1", 20, 1, 2, 10, 1));
+
 /*
     for (size_t i = 0; i < 10; ++i)
     {
@@ -65,5 +521,258 @@ main(int argc, char* argv[])
     vrd_SNV_table_destroy(&snv);
     assert(NULL == snv);
 
+    // the postings find and remove the entries of a sample alike
+    vrd_SNV_Table* plain = vrd_SNV_table_init(4, 1 << 4);
+    assert(NULL != plain);
+    vrd_SNV_Table* posted = vrd_SNV_table_init(4, 1 << 4);
+    assert(NULL != posted);
+    assert(0 == vrd_SNV_table_postings(posted));
+
+    char const* const chromosomes[3] = {"chr1", "chr2", "chr3"};
+    void* found[1000] = {0};
+    for (size_t round = 0; round < 4; ++round)
+    {
+        if (1 == round)
+        {
+            vrd_SNV_table_bulk(plain);
+            vrd_SNV_table_bulk(posted);
+        } // if
+        for (size_t i = 0; i < 1200; ++i)
+        {
+            size_t const sample = (i * 7 + round) % 20;
+            assert(0 == vrd_SNV_table_insert(plain, 5, chromosomes[i % 3], (i * 31) % 400, 1, sample, 10, 1));
+            assert(0 == vrd_SNV_table_insert(posted, 5, chromosomes[i % 3], (i * 31) % 400, 1, sample, 10, 1));
+        } // for
+        assert(0 == vrd_SNV_table_merge(plain));
+        assert(0 == vrd_SNV_table_merge(posted));
+        if (2 == round)
+        {
+            assert(0 == vrd_SNV_table_reorder(plain));
+            assert(0 == vrd_SNV_table_reorder(posted));
+        } // if
+
+        vrd_AVL_Tree* removed = vrd_AVL_tree_init(3);
+        assert(NULL != removed);
+        assert(0 == vrd_AVL_tree_insert(removed, round * 3));
+        assert(0 == vrd_AVL_tree_insert(removed, round * 3 + 1));
+        size_t const removed_count = vrd_SNV_table_remove(plain, removed);
+        assert(0 < removed_count && removed_count == vrd_SNV_table_remove(posted, removed));
+        vrd_AVL_tree_destroy(&removed);
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            assert(vrd_SNV_table_query_region_count(plain, 5, chromosomes[i], 0, 400, false, NULL) ==
+                   vrd_SNV_table_query_region_count(posted, 5, chromosomes[i], 0, 400, false, NULL));
+            for (size_t sample = 0; sample < 20; ++sample)
+            {
+                size_t const found_count = vrd_SNV_table_query_sample(plain, 5, chromosomes[i], sample, 1000, found);
+                assert(found_count == vrd_SNV_table_query_sample(posted, 5, chromosomes[i], sample, 1000, found));
+                for (size_t j = 0; j < found_count; ++j)
+                {
+                    vrd_SNV_unpack(found[j], &position, &allele_count, &sample_id, &phase, &inserted);
+                    assert(sample == sample_id);
+                } // for
+            } // for
+        } // for
+    } // for
+    assert((size_t) -1 == vrd_SNV_table_query_sample(posted, 4, "chrX", 0, 1000, found));
+
+    // and are kept for loaded trees
+    assert(0 == vrd_SNV_table_write(posted, "test_snv_table"));
+    vrd_SNV_table_destroy(&posted);
+    posted = vrd_SNV_table_init(4, 1 << 4);
+    assert(NULL != posted);
+    assert(0 == vrd_SNV_table_postings(posted));
+    assert(0 == vrd_SNV_table_read(posted, "test_snv_table"));
+    (void) remove("test_snv_table");
+    for (size_t sample = 0; sample < 20; ++sample)
+    {
+        assert(vrd_SNV_table_query_sample(plain, 5, "chr2", sample, 1000, found) ==
+               vrd_SNV_table_query_sample(posted, 5, "chr2", sample, 1000, found));
+    } // for
+
+    vrd_AVL_Tree* all_samples = vrd_AVL_tree_init(20);
+    assert(NULL != all_samples);
+    for (size_t sample = 0; sample < 20; ++sample)
+    {
+        assert(0 == vrd_AVL_tree_insert(all_samples, sample));
+    } // for
+    assert(vrd_SNV_table_remove(plain, all_samples) == vrd_SNV_table_remove(posted, all_samples));
+    assert(0 == vrd_SNV_table_query_region_count(posted, 5, "chr1", 0, 400, false, NULL));
+    vrd_AVL_tree_destroy(&all_samples);
+
+    vrd_SNV_table_destroy(&plain);
+    vrd_SNV_table_destroy(&posted);
+
+    // the carriers of a variant shared by many samples are a contiguous
+    // range of the tree, also after a bulk load
+    vrd_SNV_Table* shared = vrd_SNV_table_init(4, 1 << 12);
+    assert(NULL != shared);
+    vrd_AVL_Tree* carriers = vrd_AVL_tree_init(600);
+    assert(NULL != carriers);
+    for (size_t i = 0; i < 600; ++i)
+    {
+        if (300 == i)
+        {
+            vrd_SNV_table_bulk(shared);
+        } // if
+        size_t const sample = (i * 7) % 600;
+        assert(0 == vrd_SNV_table_insert(shared, 5, "chr1", 100, 1 + i % 2, sample, i % 3 ? 0 : VRD_HOMOZYGOUS, i % 4));
+        assert(0 == vrd_SNV_table_insert(shared, 5, "chr1", 99 + i % 3 * 2, 1, sample, 0, i % 4));
+        assert(0 == vrd_AVL_tree_insert(carriers, sample));
+    } // for
+    assert(0 == vrd_SNV_table_merge(shared));
+
+    for (size_t inserted_idx = 0; inserted_idx < 5; ++inserted_idx)
+    {
+        size_t all = 0;
+        size_t homozygous = 0;
+        for (size_t i = 0; i < 600; ++i)
+        {
+            if (inserted_idx == i % 4)
+            {
+                all += 1 + i % 2;
+                homozygous += i % 3 ? 0 : 1 + i % 2;
+            } // if
+        } // for
+        assert(all == vrd_SNV_table_query(shared, 5, "chr1", 100, inserted_idx, false, NULL));
+        assert(all == vrd_SNV_table_query(shared, 5, "chr1", 100, inserted_idx, false, carriers));
+        assert(homozygous == vrd_SNV_table_query(shared, 5, "chr1", 100, inserted_idx, true, NULL));
+        assert(homozygous == vrd_SNV_table_query(shared, 5, "chr1", 100, inserted_idx, true, carriers));
+    } // for
+    assert(0 == vrd_SNV_table_query(shared, 5, "chr1", 102, 0, false, NULL));
+
+    // batched lookups answer the same, also for a subset of the carriers
+    vrd_AVL_Tree* even = vrd_AVL_tree_init(300);
+    assert(NULL != even);
+    for (size_t i = 0; i < 600; i += 2)
+    {
+        assert(0 == vrd_AVL_tree_insert(even, i));
+    } // for
+    size_t batch_position[40] = {0};
+    size_t batch_inserted[40] = {0};
+    size_t batch[40] = {0};
+    for (size_t i = 0; i < 40; ++i)
+    {
+        batch_position[i] = 98 + i % 5;
+        batch_inserted[i] = i / 5 % 5;
+    } // for
+    for (size_t homozygous = 0; homozygous < 2; ++homozygous)
+    {
+        assert(0 == vrd_SNV_table_query_batch(shared, 5, "chr1", 40, batch_position, batch_inserted, homozygous, NULL, batch));
+        for (size_t i = 0; i < 40; ++i)
+        {
+            assert(batch[i] == vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, NULL));
+        } // for
+        assert(0 == vrd_SNV_table_query_batch(shared, 5, "chr1", 40, batch_position, batch_inserted, homozygous, carriers, batch));
+        for (size_t i = 0; i < 40; ++i)
+        {
+            assert(batch[i] == vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, NULL));
+        } // for
+        size_t left_out = 0;
+        assert(0 == vrd_SNV_table_query_batch(shared, 5, "chr1", 40, batch_position, batch_inserted, homozygous, even, batch));
+        for (size_t i = 0; i < 40; ++i)
+        {
+            assert(batch[i] == vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, even));
+            left_out += vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, NULL) - batch[i];
+        } // for
+        assert(0 < left_out);
+    } // for
+
+    // lookups in order of the tree pass it once, lookups out of order
+    // (the last ones) pass it again
+    for (size_t i = 0; i < 40; ++i)
+    {
+        batch_position[i] = i < 30 ? 98 + i / 6 : 130 - i;
+        batch_inserted[i] = i % 6;
+    } // for
+    for (size_t homozygous = 0; homozygous < 2; ++homozygous)
+    {
+        assert(0 == vrd_SNV_table_query_sorted(shared, 5, "chr1", 40, batch_position, batch_inserted, homozygous, NULL, batch));
+        for (size_t i = 0; i < 40; ++i)
+        {
+            assert(batch[i] == vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, NULL));
+        } // for
+        assert(0 == vrd_SNV_table_query_sorted(shared, 5, "chr1", 40, batch_position, batch_inserted, homozygous, carriers, batch));
+        for (size_t i = 0; i < 40; ++i)
+        {
+            assert(batch[i] == vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, carriers));
+        } // for
+        size_t left_out = 0;
+        assert(0 == vrd_SNV_table_query_sorted(shared, 5, "chr1", 40, batch_position, batch_inserted, homozygous, even, batch));
+        for (size_t i = 0; i < 40; ++i)
+        {
+            assert(batch[i] == vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, even));
+            left_out += vrd_SNV_table_query(shared, 5, "chr1", batch_position[i], batch_inserted[i], homozygous, NULL) - batch[i];
+        } // for
+        assert(0 < left_out);
+    } // for
+    assert(-1 == vrd_SNV_table_query_sorted(shared, 5, "chrX", 40, batch_position, batch_inserted, false, NULL, batch));
+
+    vrd_AVL_tree_destroy(&even);
+    vrd_AVL_tree_destroy(&carriers);
+    vrd_SNV_table_destroy(&shared);
+
+    // trees with child pointers outside their nodes are not read
+    vrd_SNV_Tree* tree = vrd_SNV_tree_init(100);
+    assert(NULL != tree);
+    for (size_t i = 0; i < 100; ++i)
+    {
+        assert(0 == vrd_SNV_tree_insert(tree, i, 1, i % 7, 0, i % 4));
+    } // for
+    FILE* const written = tmpfile();
+    assert(NULL != written);
+    assert(0 == vrd_SNV_tree_write(tree, written));
+    long const written_size = ftell(written);
+    assert(0 < written_size);
+    char* const bytes = malloc(written_size);
+    assert(NULL != bytes);
+    rewind(written);
+    assert((size_t) written_size == fread(bytes, 1, written_size, written));
+    fclose(written);
+
+    // node counts larger than the section are not reserved, and a short
+    // read leaves the tree empty
+    FILE* const truncated = tmpfile();
+    assert(NULL != truncated);
+    assert((size_t) written_size / 2 == fwrite(bytes, 1, written_size / 2, truncated));
+    rewind(truncated);
+    assert(-1 == vrd_SNV_tree_read(tree, truncated, written_size - 1));
+    assert(1 == vrd_SNV_tree_query(tree, 10, 2, false, NULL));
+    rewind(truncated);
+    assert(-1 == vrd_SNV_tree_read(tree, truncated, written_size));
+    assert(0 == vrd_SNV_tree_query(tree, 10, 2, false, NULL));
+    fclose(truncated);
+
+    // all but the header
+    size_t const node_size = written_size / 101;
+    memset(bytes + node_size, 0xff, written_size - node_size);
+    assert(NULL == vrd_SNV_tree_map(bytes, written_size));
+    FILE* const corrupt = tmpfile();
+    assert(NULL != corrupt);
+    assert((size_t) written_size == fwrite(bytes, 1, written_size, corrupt));
+    rewind(corrupt);
+    assert(0 != vrd_SNV_tree_read(tree, corrupt, written_size));
+    fclose(corrupt);
+    assert(0 == vrd_SNV_tree_query(tree, 10, 2, false, NULL));
+    free(bytes);
+
+    // packed node counts larger than the section are not reserved
+    FILE* const packed = tmpfile();
+    assert(NULL != packed);
+    assert(0 == vrd_SNV_tree_write_packed(tree, packed));
+    long const packed_size = ftell(packed);
+    assert(0 < packed_size);
+    rewind(packed);
+    uint32_t const huge = UINT32_MAX - 1;
+    assert(1 == fwrite(&huge, sizeof(huge), 1, packed));
+    rewind(packed);
+    assert(-1 == vrd_SNV_tree_read_packed(tree, packed, packed_size));
+    rewind(packed);
+    assert(-1 == vrd_SNV_tree_read_packed(tree, packed, 2));
+    fclose(packed);
+    assert(0 == vrd_SNV_tree_query(tree, 10, 2, false, NULL));
+    vrd_SNV_tree_destroy(&tree);
+
     return EXIT_SUCCESS;
 } // main
@@ -1,11 +1,37 @@
 #include <assert.h>     // assert
+#include <pthread.h>    // pthread_create, pthread_join, pthread_t
 #include <stddef.h>     // NULL, size_t
-#include <stdio.h>      // FILE, fclose, fopen, fprintf, stderr
+#include <stdio.h>      // FILE, fclose, fopen, fprintf, remove, stderr
 #include <stdlib.h>     // EXIT_*
+#include <sys/types.h>  // pid_t
 
 #include "../include/varda.h"   // vrd_*
 
 
+struct Import
+{
+    vrd_SNV_Table* snv;
+    vrd_MNV_Table* mnv;
+    vrd_Seq_Table* seq;
+    size_t sample_id;
+    size_t count;
+}; // Import
+
+
+static void*
+import(void* const arg)
+{
+    struct Import* const job = arg;
+
+    FILE* const stream = fopen("../python_ext/tests/test_variants_small.varda", "r");
+    assert(NULL != stream);
+    job->count = vrd_variants_from_file(stream, job->snv, job->mnv, job->seq, job->sample_id, NULL);
+    fclose(stream);
+
+    return NULL;
+} // import
+
+
 int
 main(int argc, char* argv[])
 {
@@ -24,11 +50,152 @@ main(int argc, char* argv[])
     FILE* const stream = fopen("../python_ext/tests/test_variants_small.varda", "r");
     assert(NULL != stream);
 
-    size_t const ret = vrd_variants_from_file(stream, snv, mnv, seq, 1);
+    size_t const ret = vrd_variants_from_file(stream, snv, mnv, seq, 1, NULL);
     assert(3 == ret);
 
     fclose(stream);
 
+    vrd_Cov_Table* cov = vrd_Cov_table_init(10, 1000);
+    assert(NULL != cov);
+
+    int const err = vrd_database_write("test_variants_from_file", cov, snv, mnv, seq, 0, 1);
+    assert(0 == err);
+
+    vrd_Cov_Table* cov_copy = vrd_Cov_table_init(10, 1000);
+    assert(NULL != cov_copy);
+    vrd_SNV_Table* snv_copy = vrd_SNV_table_init(10, 1000);
+    assert(NULL != snv_copy);
+    vrd_MNV_Table* mnv_copy = vrd_MNV_table_init(10, 1000);
+    assert(NULL != mnv_copy);
+    vrd_Seq_Table* seq_copy = vrd_Seq_table_init(1000);
+    assert(NULL != seq_copy);
+
+    assert(0 == vrd_database_map("test_variants_from_file", cov_copy, snv_copy, mnv_copy, seq_copy, 1));
+
+    size_t count[10] = {0};
+    assert(1 == vrd_SNV_table_sample_count(snv_copy, count));
+    assert(1 == vrd_MNV_table_sample_count(mnv_copy, count));
+    assert(3 == count[1]);
+
+    vrd_Seq_table_destroy(&seq_copy);
+    vrd_MNV_table_destroy(&mnv_copy);
+    vrd_SNV_table_destroy(&snv_copy);
+    vrd_Cov_table_destroy(&cov_copy);
+
+    assert(0 == vrd_database_write("test_variants_from_file", cov, snv, mnv, seq, VRD_CHECKPOINT_PACK, 4));
+
+    cov_copy = vrd_Cov_table_init(10, 1000);
+    assert(NULL != cov_copy);
+    snv_copy = vrd_SNV_table_init(10, 1000);
+    assert(NULL != snv_copy);
+    mnv_copy = vrd_MNV_table_init(10, 1000);
+    assert(NULL != mnv_copy);
+    seq_copy = vrd_Seq_table_init(1000);
+    assert(NULL != seq_copy);
+
+    assert(0 == vrd_database_read("test_variants_from_file", cov_copy, snv_copy, mnv_copy, seq_copy, 4));
+
+    size_t packed_count[10] = {0};
+    assert(1 == vrd_SNV_table_sample_count(snv_copy, packed_count));
+    assert(1 == vrd_MNV_table_sample_count(mnv_copy, packed_count));
+    assert(3 == packed_count[1]);
+
+    vrd_Seq_table_destroy(&seq_copy);
+    vrd_MNV_table_destroy(&mnv_copy);
+    vrd_SNV_table_destroy(&snv_copy);
+    vrd_Cov_table_destroy(&cov_copy);
+
+    // the snapshot holds a concurrent import either as a whole or not at
+    // all, and is unaffected by the inserts that follow it
+    struct Import job = {snv, mnv, seq, 2, 0};
+    pthread_t thread;
+    assert(0 == pthread_create(&thread, NULL, import, &job));
+    pid_t const pid = vrd_database_snapshot("test_variants_from_file", cov, snv, mnv, seq, 0);
+    assert(0 < pid);
+    assert(0 == pthread_join(thread, NULL));
+    assert(3 == job.count);
+
+    assert(0 == vrd_snapshot_wait(pid));
+
+    cov_copy = vrd_Cov_table_init(10, 1000);
+    assert(NULL != cov_copy);
+    snv_copy = vrd_SNV_table_init(10, 1000);
+    assert(NULL != snv_copy);
+    mnv_copy = vrd_MNV_table_init(10, 1000);
+    assert(NULL != mnv_copy);
+    seq_copy = vrd_Seq_table_init(1000);
+    assert(NULL != seq_copy);
+
+    assert(0 == vrd_database_read("test_variants_from_file", cov_copy, snv_copy, mnv_copy, seq_copy, 1));
+
+    size_t snapshot_count[10] = {0};
+    assert(1 == vrd_SNV_table_sample_count(snv_copy, snapshot_count));
+    assert(1 == vrd_MNV_table_sample_count(mnv_copy, snapshot_count));
+    assert(3 == snapshot_count[1]);
+    assert(0 == snapshot_count[2] || 3 == snapshot_count[2]);
+
+    // recover the inserts after the snapshot from the write-ahead log
+    (void) remove("test_variants_from_file.wal");
+    vrd_WAL* wal = vrd_wal_open("test_variants_from_file.wal", 2);
+    assert(NULL != wal);
+    assert(0 == vrd_wal_reset(wal, "test_variants_from_file"));
+
+    FILE* const logged = fopen("../python_ext/tests/test_variants_small.varda", "r");
+    assert(NULL != logged);
+    assert(3 == vrd_variants_from_file(logged, snv, mnv, seq, 3, wal));
+    fclose(logged);
+    assert(0 == vrd_wal_close(&wal));
+
+    size_t replayed = 0;
+    assert(0 == vrd_wal_replay("test_variants_from_file.wal", NULL, cov_copy, snv_copy, mnv_copy, seq_copy, &replayed));
+    assert(0 == replayed);
+    assert(0 == vrd_wal_replay("test_variants_from_file.wal", "test_variants_from_file", cov_copy, snv_copy, mnv_copy, seq_copy, &replayed));
+    assert(3 == replayed);
+
+    size_t recovered_count[10] = {0};
+    assert(3 == vrd_SNV_table_sample_count(snv_copy, recovered_count));
+    assert(3 == vrd_MNV_table_sample_count(mnv_copy, recovered_count));
+    assert(3 == recovered_count[1]);
+    assert(snapshot_count[2] == recovered_count[2]);
+    assert(3 == recovered_count[3]);
+
+    // a retraction is replayed until its compaction is: the sample ID can
+    // be reused after that
+    (void) remove("test_variants_from_file.wal");
+    wal = vrd_wal_open("test_variants_from_file.wal", 0);
+    assert(NULL != wal);
+    assert(0 == vrd_wal_snv_insert(wal, 5, "chrW", 10, 1, 4, 0, 1));
+    assert(0 == vrd_wal_snv_insert(wal, 5, "chrW", 10, 1, 5, 0, 1));
+    assert(0 == vrd_wal_retract(wal, VRD_WAL_SNV, 4));
+    assert(0 == vrd_wal_commit(wal));
+
+    vrd_SNV_Table* retracted = vrd_SNV_table_init(10, 1000);
+    assert(NULL != retracted);
+    assert(0 == vrd_wal_replay("test_variants_from_file.wal", NULL, cov_copy, retracted, mnv_copy, seq_copy, &replayed));
+    assert(3 == replayed);
+    assert(1 == vrd_SNV_table_query(retracted, 5, "chrW", 10, 1, false, NULL));
+    vrd_SNV_table_destroy(&retracted);
+
+    assert(0 == vrd_wal_compact(wal, VRD_WAL_SNV));
+    assert(0 == vrd_wal_snv_insert(wal, 5, "chrW", 10, 1, 4, 0, 1));
+    assert(0 == vrd_wal_close(&wal));
+
+    retracted = vrd_SNV_table_init(10, 1000);
+    assert(NULL != retracted);
+    assert(0 == vrd_wal_replay("test_variants_from_file.wal", NULL, cov_copy, retracted, mnv_copy, seq_copy, &replayed));
+    assert(5 == replayed);
+    assert(2 == vrd_SNV_table_query(retracted, 5, "chrW", 10, 1, false, NULL));
+    vrd_SNV_table_destroy(&retracted);
+
+    (void) remove("test_variants_from_file.wal");
+    (void) remove("test_variants_from_file");
+
+    vrd_Seq_table_destroy(&seq_copy);
+    vrd_MNV_table_destroy(&mnv_copy);
+    vrd_SNV_table_destroy(&snv_copy);
+    vrd_Cov_table_destroy(&cov_copy);
+    vrd_Cov_table_destroy(&cov);
+
     vrd_Seq_table_destroy(&seq);
     vrd_MNV_table_destroy(&mnv);
     vrd_SNV_table_destroy(&snv);